@@ -23,6 +23,7 @@ namespace Gui
 
 	void XyPad::Thumb::mouseDrag(const MouseEvent& event)
 	{
+		XYPAD_TRACE_SCOPE("XyPad::Thumb::mouseDrag");
 		dragger.dragComponent(this, event, &constrainer);
 		if (moveCallback)
 			moveCallback(getPosition().toDouble());
@@ -70,6 +71,7 @@ namespace Gui
 
 	void XyPad::paint(Graphics& g)
 	{
+		XYPAD_TRACE_SCOPE("XyPad::paint");
 		g.setColour(Colours::black);
 		g.fillRoundedRectangle(getLocalBounds().toFloat(), 10.f);
 	}
@@ -95,6 +97,8 @@ namespace Gui
 
 	void XyPad::sliderValueChanged(Slider* slider)
 	{
+		XYPAD_TRACE_SCOPE("XyPad::sliderValueChanged");
+
 		// Avoid loopback
 		if (thumb.isMouseOverOrDragging(false))
 			return;
@@ -0,0 +1,327 @@
+#include "DelayLine.h"
+
+template <typename SampleType>
+void DelayLine<SampleType>::allocate(int maxNumChannels, int maximumDelayInSamples, int maximumBlockSize) {
+    // A fresh allocation, so switching to a smaller layout gives memory back
+    const auto length = getStorageLength(maximumDelayInSamples, maximumBlockSize);
+    buffer.setSize(maxNumChannels, length);
+    allocatedStorageSamples = static_cast<size_t>(maxNumChannels) * static_cast<size_t>(length);
+
+    prepare(maxNumChannels, maximumDelayInSamples, maximumBlockSize);
+}
+
+template <typename SampleType>
+int DelayLine<SampleType>::getStorageLength(int maximumDelayInSamples, int maximumBlockSize) {
+    // Room for the longest delay behind the block being written, plus the extra
+    // taps Lagrange interpolation reaches on either side, plus the guard
+    return nextPowerOfTwo(maximumDelayInSamples + maximumBlockSize + 4) + maximumBlockSize + 4;
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::prepare(int numChannels, int maximumDelayInSamples, int maximumBlockSize) {
+    maximumDelay = maximumDelayInSamples;
+    capacity = nextPowerOfTwo(maximumDelayInSamples + maximumBlockSize + 4);
+    mask = capacity - 1;
+    guard = maximumBlockSize + 4;
+
+    // Reuses the existing allocation whenever it is big enough, which after
+    // allocate() is every configuration the processor supports
+    const auto length = capacity + guard;
+    const auto storageSamples = static_cast<size_t>(numChannels) * static_cast<size_t>(length);
+    jassert(storageSamples <= allocatedStorageSamples || allocatedStorageSamples == 0);
+
+    buffer.setSize(numChannels, length, false, false, true);
+    allocatedStorageSamples = jmax(allocatedStorageSamples, storageSamples);
+
+    if (maximumBlockSize > scratchCapacity) {
+        readIndices.allocate(static_cast<size_t>(maximumBlockSize), true);
+        fractions.allocate(static_cast<size_t>(maximumBlockSize), true);
+        scratchCapacity = maximumBlockSize;
+    }
+
+    thiranStates.resize(static_cast<size_t>(numChannels));
+
+    reset();
+}
+
+template <typename SampleType>
+size_t DelayLine<SampleType>::getMemoryFootprintBytes() const noexcept {
+    return allocatedStorageSamples * sizeof(SampleType)
+         + static_cast<size_t>(scratchCapacity) * (sizeof(int) + sizeof(SampleType))
+         + thiranStates.capacity() * sizeof(SampleType);
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::release() {
+    buffer.setSize(0, 0);
+    readIndices.free();
+    fractions.free();
+    thiranStates = {};
+    allocatedStorageSamples = 0;
+    scratchCapacity = 0;
+    capacity = mask = guard = writePosition = 0;
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::reset() {
+    buffer.clear();
+    std::fill(thiranStates.begin(), thiranStates.end(), SampleType());
+    writePosition = 0;
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::setInterpolation(Interpolation newInterpolation) {
+    if (newInterpolation == interpolation)
+        return;
+
+    interpolation = newInterpolation;
+    std::fill(thiranStates.begin(), thiranStates.end(), SampleType());
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::write(const AudioBuffer<SampleType>& source, int numSamples) {
+    write(source.getArrayOfReadPointers(), source.getNumChannels(), numSamples);
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::write(const SampleType* const* source, int numChannels, int numSamples) {
+    jassert(numSamples <= capacity - maximumDelay && numSamples <= guard);
+
+    const auto firstPart = jmin(numSamples, capacity - writePosition);
+    numChannels = jmin(numChannels, buffer.getNumChannels());
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        writeSpan(channel, writePosition, source[channel], firstPart);
+
+        if (firstPart < numSamples)
+            writeSpan(channel, 0, source[channel] + firstPart, numSamples - firstPart);
+    }
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::writeSpan(int channel, int position, const SampleType* source, int numSamples) {
+    buffer.copyFrom(channel, position, source, numSamples);
+
+    // The start of the ring is repeated in the guard
+    if (position < guard)
+        buffer.copyFrom(channel, capacity + position, source, jmin(numSamples, guard - position));
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::advance(int numSamples) {
+    writePosition = (writePosition + numSamples) & mask;
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::writeSilence(int numSamples) {
+    // Past one lap every sample has been cleared once already
+    const auto numToClear = jmin(numSamples, capacity);
+    const auto firstPart = jmin(numToClear, capacity - writePosition);
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+        clearSpan(channel, writePosition, firstPart);
+
+        if (firstPart < numToClear)
+            clearSpan(channel, 0, numToClear - firstPart);
+    }
+
+    advance(numSamples);
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::clearSpan(int channel, int position, int numSamples) {
+    buffer.clear(channel, position, numSamples);
+
+    if (position < guard)
+        buffer.clear(channel, capacity + position, jmin(numSamples, guard - position));
+}
+
+template <typename SampleType>
+const SampleType* DelayLine<SampleType>::getSpan(const SampleType* data, int delay) const noexcept {
+    // Start of the numSamples-long run whose first sample is delay samples behind
+    // the write head; it may run on into the guard
+    return data + ((writePosition - delay) & mask);
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::computeTaps(const float* delayInSamples, int numSamples, int minimumIntegerDelay, int numOlderTaps) {
+    const auto maxDelay = static_cast<float>(maximumDelay);
+
+    for (int i = 0; i < numSamples; ++i) {
+        const auto delay = jlimit(0.0f, maxDelay, delayInSamples[i]);
+        const auto whole = jmax(0, static_cast<int>(delay) - minimumIntegerDelay);
+
+        // The oldest tap, so the newer ones are reached by adding and run into the guard at worst
+        readIndices[i] = (writePosition + i - whole - numOlderTaps) & mask;
+        fractions[i] = delay - static_cast<float>(whole);
+    }
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::read(int channel, const float* delayInSamples, SampleType* destination, int numSamples) {
+    read(&channel, 1, delayInSamples, &destination, numSamples);
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::read(const int* channels, int numChannels, const float* delayInSamples, SampleType* const* destinations, int numSamples) {
+    // Tap positions only depend on the delay curve, so they are computed once
+    // and every channel in the group is interpolated from them. Lagrange
+    // centres its four taps around the read point whenever the delay allows it.
+    if (interpolation == Interpolation::lagrange)
+        computeTaps(delayInSamples, numSamples, 1, 3);
+    else
+        computeTaps(delayInSamples, numSamples, 0, 1);
+
+    for (int i = 0; i < numChannels; ++i) {
+        const auto channel = channels[i];
+        const auto* data = buffer.getReadPointer(channel);
+
+        switch (interpolation) {
+            case Interpolation::linear:
+                readLinear(data, destinations[i], numSamples);
+                break;
+
+            case Interpolation::lagrange:
+                readLagrange(data, destinations[i], numSamples);
+                break;
+
+            case Interpolation::thiran:
+                readThiran(data, delayInSamples, destinations[i], numSamples, thiranStates[static_cast<size_t>(channel)]);
+                break;
+        }
+    }
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::read(int channel, float delayInSamples, SampleType* destination, int numSamples) {
+    const auto* data = buffer.getReadPointer(channel);
+    const auto delay = jlimit(0.0f, static_cast<float>(maximumDelay), delayInSamples);
+    const auto whole = static_cast<int>(delay);
+    const auto frac = delay - static_cast<float>(whole);
+
+    // Whole-sample delays are a straight copy whatever the interpolation
+    if (frac == 0.0f && interpolation != Interpolation::thiran) {
+        FloatVectorOperations::copy(destination, getSpan(data, whole), numSamples);
+        return;
+    }
+
+    switch (interpolation) {
+        case Interpolation::linear: {
+            FloatVectorOperations::copyWithMultiply(destination, getSpan(data, whole), static_cast<SampleType>(1.0f - frac), numSamples);
+            FloatVectorOperations::addWithMultiply(destination, getSpan(data, whole + 1), static_cast<SampleType>(frac), numSamples);
+            break;
+        }
+
+        case Interpolation::lagrange: {
+            const auto first = jmax(0, whole - 1);
+            const auto f = static_cast<SampleType>(delay - static_cast<float>(first));
+            const auto d1 = f - 1, d2 = f - 2, d3 = f - 3;
+
+            FloatVectorOperations::copyWithMultiply(destination, getSpan(data, first), -d1 * d2 * d3 / 6, numSamples);
+            FloatVectorOperations::addWithMultiply(destination, getSpan(data, first + 1), f * d2 * d3 / 2, numSamples);
+            FloatVectorOperations::addWithMultiply(destination, getSpan(data, first + 2), -f * d1 * d3 / 2, numSamples);
+            FloatVectorOperations::addWithMultiply(destination, getSpan(data, first + 3), f * d1 * d2 / 6, numSamples);
+            break;
+        }
+
+        case Interpolation::thiran: {
+            // The allpass is recursive, but its taps are still two contiguous spans
+            auto first = whole;
+            auto f = frac;
+
+            if (f < 0.618f && whole >= 1) {
+                f += 1.0f;
+                --first;
+            }
+
+            const auto* newer = getSpan(data, first);
+            const auto* older = getSpan(data, first + 1);
+            const auto alpha = (1.0f - f) / (1.0f + f);
+            auto& state = thiranStates[static_cast<size_t>(channel)];
+            auto previous = state;
+
+            if (f == 0.0f) {
+                FloatVectorOperations::copy(destination, newer, numSamples);
+                previous = newer[numSamples - 1];
+            } else {
+                for (int i = 0; i < numSamples; ++i) {
+                    previous = older[i] + alpha * (newer[i] - previous);
+                    destination[i] = previous;
+                }
+            }
+
+            state = previous;
+            break;
+        }
+    }
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::skipUndelayed(int channel, int numSamples) {
+    // Only the Thiran allpass remembers anything between reads
+    thiranStates[static_cast<size_t>(channel)] = getSpan(buffer.getReadPointer(channel), 0)[numSamples - 1];
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::readLinear(const SampleType* data, SampleType* destination, int numSamples) const {
+    for (int i = 0; i < numSamples; ++i) {
+        const auto index = readIndices[i];
+        const auto frac = fractions[i];
+        const auto value1 = data[index + 1];
+        const auto value2 = data[index];
+
+        destination[i] = value1 + frac * (value2 - value1);
+    }
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::readLagrange(const SampleType* data, SampleType* destination, int numSamples) const {
+    for (int i = 0; i < numSamples; ++i) {
+        const auto index = readIndices[i];
+        const auto frac = fractions[i];
+
+        const auto value1 = data[index + 3];
+        const auto value2 = data[index + 2];
+        const auto value3 = data[index + 1];
+        const auto value4 = data[index];
+
+        const auto d1 = frac - 1.0f;
+        const auto d2 = frac - 2.0f;
+        const auto d3 = frac - 3.0f;
+
+        const auto c1 = -d1 * d2 * d3 / 6.0f;
+        const auto c2 = d2 * d3 * 0.5f;
+        const auto c3 = -d1 * d3 * 0.5f;
+        const auto c4 = d1 * d2 / 6.0f;
+
+        destination[i] = value1 * c1 + frac * (value2 * c2 + value3 * c3 + value4 * c4);
+    }
+}
+
+template <typename SampleType>
+void DelayLine<SampleType>::readThiran(const SampleType* data, const float* delayInSamples, SampleType* destination, int numSamples, SampleType& state) const {
+    auto previous = state;
+
+    for (int i = 0; i < numSamples; ++i) {
+        auto index = readIndices[i];
+        auto frac = fractions[i];
+
+        // Keep the allpass fraction in its well-behaved range by borrowing a whole sample
+        if (frac < 0.618f && delayInSamples[i] >= 1.0f) {
+            frac += 1.0f;
+            index = (index + 1) & mask;
+        }
+
+        const auto value1 = data[index + 1];
+        const auto value2 = data[index];
+        const auto alpha = (1.0f - frac) / (1.0f + frac);
+
+        previous = frac == 0.0f ? value1 : value2 + alpha * (value1 - previous);
+        destination[i] = previous;
+    }
+
+    state = previous;
+}
+
+template class DelayLine<float>;
+template class DelayLine<double>;
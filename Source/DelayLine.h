@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    DelayLine.h
+    Multichannel fractional delay line with a single write head and
+    per-sample delay times, read a block at a time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Templated on the sample type so the float and double processing paths
+// share one implementation; both are instantiated in DelayLine.cpp. Delay
+// times are float samples either way.
+template <typename SampleType>
+class DelayLine {
+public:
+    enum class Interpolation { linear, lagrange, thiran };
+
+    DelayLine() = default;
+
+    // Allocates for the largest configuration prepare() will ever be called
+    // with. Call once, off the audio thread.
+    void allocate(int maxNumChannels, int maximumDelayInSamples, int maximumBlockSize);
+
+    // Configures for maximumDelayInSamples plus one block and clears the line,
+    // reusing the storage from allocate() when it is large enough; call from prepareToPlay.
+    void prepare(int numChannels, int maximumDelayInSamples, int maximumBlockSize);
+    void reset();
+
+    // Frees everything allocate() and prepare() acquired.
+    void release();
+
+    size_t getMemoryFootprintBytes() const noexcept;
+
+    void setInterpolation(Interpolation newInterpolation);
+    Interpolation getInterpolation() const noexcept { return interpolation; }
+
+    // Writes the next numSamples of every channel at the write head. The
+    // block becomes readable straight away (a delay of 0 returns the input),
+    // and the head only moves on advance().
+    void write(const AudioBuffer<SampleType>& source, int numSamples);
+    void write(const SampleType* const* source, int numChannels, int numSamples);
+
+    // Reads numSamples for one channel, delayInSamples[i] being the delay of
+    // output sample i relative to the sample written at the same position.
+    void read(int channel, const float* delayInSamples, SampleType* destination, int numSamples);
+
+    // Same as above for a group of channels that share one delay curve: the
+    // taps are computed once and reused for every channel in the group.
+    void read(const int* channels, int numChannels, const float* delayInSamples, SampleType* const* destinations, int numSamples);
+
+    // Same as read() for a delay that is constant over the block: the taps
+    // are contiguous spans, so this is a memcpy or a few vector ops.
+    void read(int channel, float delayInSamples, SampleType* destination, int numSamples);
+
+    // Stands in for read(channel, 0.0f, ...) when the caller already has the
+    // input it would return: leaves the channel as a zero-delay read would.
+    void skipUndelayed(int channel, int numSamples);
+
+    void advance(int numSamples);
+
+    // Writes numSamples of silence at the write head and advances past them,
+    // any number of samples at once. Stands in for write() and advance()
+    // when the input is known to be silent.
+    void writeSilence(int numSamples);
+
+private:
+    // Every channel holds a power-of-two ring followed by a guard that
+    // repeats its first block's worth of samples. Any span of up to one block
+    // that starts inside the ring is contiguous in memory, so reads never
+    // wrap and positions only need a mask, at the cost of one block of
+    // memory rather than a full mirrored copy.
+    AudioBuffer<SampleType> buffer;
+    int capacity = 0;
+    int mask = 0;
+    int guard = 0;
+    int writePosition = 0;
+    int maximumDelay = 0;
+    Interpolation interpolation = Interpolation::linear;
+
+    // Block scratch: tap positions (of the oldest tap, so newer taps are
+    // reached by adding) and fractional parts, filled
+    // by a first vectorisable pass and consumed by the interpolation pass.
+    HeapBlock<int> readIndices;
+    HeapBlock<SampleType> fractions;
+    int scratchCapacity = 0;
+    std::vector<SampleType> thiranStates;
+
+    size_t allocatedStorageSamples = 0;
+
+    static int getStorageLength(int maximumDelayInSamples, int maximumBlockSize);
+    void writeSpan(int channel, int position, const SampleType* source, int numSamples);
+    void clearSpan(int channel, int position, int numSamples);
+    void computeTaps(const float* delayInSamples, int numSamples, int minimumIntegerDelay, int numOlderTaps);
+    void readLinear(const SampleType* data, SampleType* destination, int numSamples) const;
+    void readLagrange(const SampleType* data, SampleType* destination, int numSamples) const;
+    void readThiran(const SampleType* data, const float* delayInSamples, SampleType* destination, int numSamples, SampleType& state) const;
+
+    const SampleType* getSpan(const SampleType* data, int delay) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DelayLine)
+};
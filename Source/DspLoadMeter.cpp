@@ -0,0 +1,115 @@
+#include "DspLoadMeter.h"
+
+const char* DspLoadMeter::getStageName(Stage stage) noexcept {
+    static const char* const names[] = { "processBlock", "filter", "delay", "mix" };
+    return names[static_cast<int>(stage)];
+}
+
+DspLoadMeter::ScopedBlock::ScopedBlock(DspLoadMeter& meterToUse, int numSamples, double sampleRate) noexcept
+    : meter(meterToUse) {
+   #if XYPAD_DSP_LOAD_METER || XYPAD_TRACE
+    meter.stageTicks.fill(0);
+    budgetMicroseconds = static_cast<float>(numSamples / sampleRate * 1.0e6);
+    start = Time::getHighResolutionTicks();
+   #else
+    ignoreUnused(numSamples, sampleRate);
+   #endif
+}
+
+DspLoadMeter::ScopedBlock::~ScopedBlock() {
+   #if XYPAD_DSP_LOAD_METER || XYPAD_TRACE
+    const auto end = Time::getHighResolutionTicks();
+   #endif
+   #if XYPAD_TRACE
+    Trace::record(getStageName(Stage::total), start, end);
+   #endif
+   #if XYPAD_DSP_LOAD_METER
+    meter.stageTicks[static_cast<size_t>(Stage::total)] = end - start;
+
+    // Converted once here so the reader never needs the tick rate
+    const auto microsecondsPerTick = 1.0e6 / static_cast<double>(Time::getHighResolutionTicksPerSecond());
+    Record record;
+    record.budgetMicroseconds = budgetMicroseconds;
+
+    for (size_t stage = 0; stage < numStages; ++stage)
+        record.microseconds[stage] = static_cast<float>(static_cast<double>(meter.stageTicks[stage]) * microsecondsPerTick);
+
+    meter.pushRecord(record);
+   #endif
+}
+
+void DspLoadMeter::pushRecord(const Record& record) noexcept {
+    const auto scope = fifo.write(1);
+
+    if (scope.blockSize1 > 0)
+        records[static_cast<size_t>(scope.startIndex1)] = record;
+    else if (scope.blockSize2 > 0)
+        records[static_cast<size_t>(scope.startIndex2)] = record;
+    else
+        dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+DspLoadMeter::Report DspLoadMeter::getReport() {
+    if (history.empty()) {
+        history.reserve(historySize);
+        sortScratch.resize(historySize);
+    }
+
+    const auto addToHistory = [this](const Record& record) {
+        if (static_cast<int>(history.size()) < historySize) {
+            history.push_back(record);
+        } else {
+            history[static_cast<size_t>(historyPosition)] = record;
+            historyPosition = (historyPosition + 1) % historySize;
+        }
+    };
+
+    const auto scope = fifo.read(fifo.getNumReady());
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        addToHistory(records[static_cast<size_t>(scope.startIndex1 + i)]);
+
+    for (int i = 0; i < scope.blockSize2; ++i)
+        addToHistory(records[static_cast<size_t>(scope.startIndex2 + i)]);
+
+    Report report;
+    report.numBlocks = static_cast<int>(history.size());
+    report.numDropped = dropped.exchange(0, std::memory_order_relaxed);
+
+    if (history.empty())
+        return report;
+
+    auto totalBudget = 0.0;
+
+    for (const auto& record : history)
+        totalBudget += record.budgetMicroseconds;
+
+    const auto numBlocks = history.size();
+    const auto p99Index = (numBlocks * 99) / 100;
+
+    for (size_t stage = 0; stage < numStages; ++stage) {
+        auto& statistics = report.stages[stage];
+        auto sum = 0.0;
+        statistics.minimum = std::numeric_limits<double>::max();
+
+        for (size_t i = 0; i < numBlocks; ++i) {
+            const auto time = history[i].microseconds[stage];
+            const auto load = time / history[i].budgetMicroseconds * 100.0f;
+
+            sortScratch[i] = time;
+            sum += time;
+            statistics.minimum = jmin(statistics.minimum, static_cast<double>(time));
+            statistics.maximum = jmax(statistics.maximum, static_cast<double>(time));
+            statistics.peakLoad = jmax(statistics.peakLoad, static_cast<double>(load));
+        }
+
+        std::nth_element(sortScratch.begin(), sortScratch.begin() + static_cast<std::ptrdiff_t>(p99Index),
+                         sortScratch.begin() + static_cast<std::ptrdiff_t>(numBlocks));
+
+        statistics.average = sum / static_cast<double>(numBlocks);
+        statistics.p99 = sortScratch[p99Index];
+        statistics.averageLoad = sum / totalBudget * 100.0;
+    }
+
+    return report;
+}
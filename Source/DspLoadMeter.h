@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    DspLoadMeter.h
+    Per-instance DSP load instrumentation. The audio thread times each
+    block and its stages and pushes one fixed-size record per block into a
+    lock-free FIFO; the message thread drains the records into a history
+    and computes min/avg/p99/max and the share of the real-time budget.
+
+    Timing compiles to nothing when XYPAD_DSP_LOAD_METER is 0, unless
+    XYPAD_TRACE is on, in which case every timed block and stage is also
+    recorded as a trace span.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Trace.h"
+
+#ifndef XYPAD_DSP_LOAD_METER
+ #define XYPAD_DSP_LOAD_METER 1
+#endif
+
+class DspLoadMeter {
+public:
+    // Whatever a block spends outside the named stages (smoothers, kernel
+    // selection, the bypass crossfade) only shows up in the total
+    enum class Stage { total, filter, delay, mix };
+    static constexpr int numStages = 4;
+
+    static const char* getStageName(Stage stage) noexcept;
+
+    struct Statistics {
+        double minimum = 0.0;  // microseconds
+        double average = 0.0;
+        double p99 = 0.0;
+        double maximum = 0.0;
+        double averageLoad = 0.0; // percent of the real-time budget
+        double peakLoad = 0.0;
+    };
+
+    struct Report {
+        std::array<Statistics, numStages> stages;
+        int numBlocks = 0;
+        int numDropped = 0;
+    };
+
+    DspLoadMeter() = default;
+
+    // Audio thread: times a whole block. Stage timers only count inside one.
+    class ScopedBlock {
+    public:
+        ScopedBlock(DspLoadMeter& meterToUse, int numSamples, double sampleRate) noexcept;
+        ~ScopedBlock();
+
+    private:
+        DspLoadMeter& meter;
+        int64 start = 0;
+        float budgetMicroseconds = 0.0f;
+    };
+
+    class ScopedStage {
+    public:
+        ScopedStage(DspLoadMeter& meterToUse, Stage stageToTime) noexcept
+            : meter(meterToUse), stage(stageToTime) {
+           #if XYPAD_DSP_LOAD_METER || XYPAD_TRACE
+            start = Time::getHighResolutionTicks();
+           #endif
+        }
+
+        ~ScopedStage() {
+           #if XYPAD_DSP_LOAD_METER || XYPAD_TRACE
+            const auto end = Time::getHighResolutionTicks();
+           #endif
+           #if XYPAD_DSP_LOAD_METER
+            meter.stageTicks[static_cast<size_t>(stage)] += end - start;
+           #endif
+           #if XYPAD_TRACE
+            Trace::record(getStageName(stage), start, end);
+           #endif
+        }
+
+    private:
+        DspLoadMeter& meter;
+        Stage stage;
+        int64 start = 0;
+    };
+
+    // Message thread: folds everything pushed since the last call into the
+    // history and summarises the most recent historySize blocks.
+    Report getReport();
+
+private:
+    static constexpr int capacity = 256;
+    static constexpr int historySize = 1024;
+
+    struct Record {
+        std::array<float, numStages> microseconds;
+        float budgetMicroseconds;
+    };
+
+    // Audio thread only
+    std::array<int64, numStages> stageTicks {};
+
+    AbstractFifo fifo { capacity };
+    std::array<Record, capacity> records {};
+    std::atomic<int> dropped { 0 };
+
+    // Message thread only
+    std::vector<Record> history;
+    int historyPosition = 0;
+    std::vector<float> sortScratch;
+
+    void pushRecord(const Record& record) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DspLoadMeter)
+};
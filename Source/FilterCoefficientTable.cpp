@@ -0,0 +1,44 @@
+#include "FilterCoefficientTable.h"
+
+static FilterCoefficientTable::Coefficients toTableEntry(const IIRCoefficients& coefficients) {
+    const auto* c = coefficients.coefficients;
+    return { c[0], c[1], c[2], c[3], c[4] };
+}
+
+FilterCoefficientTable::FilterCoefficientTable()
+    : logMin(std::log(minNormalisedFrequency)),
+      indexScale((tableSize - 1) / (std::log(maxNormalisedFrequency) - std::log(minNormalisedFrequency))) {
+    highPass.reserve(tableSize);
+    lowPass.reserve(tableSize);
+
+    for (int i = 0; i < tableSize; ++i) {
+        // A sample rate of 1 makes the cutoff argument the normalised frequency
+        const auto normalised = std::exp(logMin + i / indexScale);
+        highPass.push_back(toTableEntry(IIRCoefficients::makeHighPass(1.0, normalised, resonance)));
+        lowPass.push_back(toTableEntry(IIRCoefficients::makeLowPass(1.0, normalised, resonance)));
+    }
+}
+
+FilterCoefficientTable::Coefficients FilterCoefficientTable::getHighPass(double frequency, double sampleRate) const noexcept {
+    return lookup(highPass, frequency, sampleRate);
+}
+
+FilterCoefficientTable::Coefficients FilterCoefficientTable::getLowPass(double frequency, double sampleRate) const noexcept {
+    return lookup(lowPass, frequency, sampleRate);
+}
+
+FilterCoefficientTable::Coefficients FilterCoefficientTable::lookup(const std::vector<Coefficients>& table, double frequency, double sampleRate) const noexcept {
+    const auto normalised = jlimit(minNormalisedFrequency, maxNormalisedFrequency, frequency / sampleRate);
+    const auto position = (std::log(normalised) - logMin) * indexScale;
+    const auto index = jlimit(0, tableSize - 2, static_cast<int>(position));
+    const auto frac = static_cast<float>(position - index);
+
+    const auto& lo = table[static_cast<size_t>(index)];
+    const auto& hi = table[static_cast<size_t>(index) + 1];
+
+    return { lo.b0 + frac * (hi.b0 - lo.b0),
+             lo.b1 + frac * (hi.b1 - lo.b1),
+             lo.b2 + frac * (hi.b2 - lo.b2),
+             lo.a1 + frac * (hi.a1 - lo.a1),
+             lo.a2 + frac * (hi.a2 - lo.a2) };
+}
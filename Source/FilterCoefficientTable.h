@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    FilterCoefficientTable.h
+    Precomputed HPF/LPF biquad coefficients over log-spaced cutoffs,
+    shared read-only by every Filters instance in the process through
+    SharedResourcePointer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class FilterCoefficientTable {
+public:
+    struct Coefficients {
+        float b0, b1, b2, a1, a2;
+    };
+
+    // The table is built for this resonance; other values fall back to IIRCoefficients.
+    static constexpr float resonance = 0.707f;
+
+    FilterCoefficientTable();
+
+    // Interpolated lookups, no trig: one log and a lerp between neighbouring entries.
+    Coefficients getHighPass(double frequency, double sampleRate) const noexcept;
+    Coefficients getLowPass(double frequency, double sampleRate) const noexcept;
+
+private:
+    // Indexed by cutoff / sampleRate, which makes one table valid for every
+    // sample rate: 20 Hz at 384 kHz up to 20 kHz at 44.1 kHz, and a bit either side.
+    static constexpr double minNormalisedFrequency = 1.0e-5;
+    static constexpr double maxNormalisedFrequency = 0.49;
+    static constexpr int tableSize = 4096;
+
+    std::vector<Coefficients> highPass, lowPass;
+    double logMin, indexScale;
+
+    Coefficients lookup(const std::vector<Coefficients>& table, double frequency, double sampleRate) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE(FilterCoefficientTable)
+};
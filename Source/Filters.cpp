@@ -1,42 +1,213 @@
 #include "Filters.h"
 
-Filters::Filters() : currentSampleRate(44100) { // Initialize with a default sample rate
-    hpf.setCoefficients(IIRCoefficients::makeHighPass(currentSampleRate, 400, 0.707));
-    lpf.setCoefficients(IIRCoefficients::makeLowPass(currentSampleRate, 5000, 0.707));
+template <typename SampleType>
+Filters<SampleType>::Filters() : Filters(44100) { // Initialize with a default sample rate
 }
 
-void Filters::setHPFParameters(float frequency, float resonance) {
-    currentHPFFrequency = frequency;
-    updateHPFCoefficients(currentHPFFrequency, resonance);
+template <typename SampleType>
+Filters<SampleType>::Filters(double sampleRate) : currentSampleRate(sampleRate) {
+    setHPFParameters(400, 0.707f);
+    setLPFParameters(5000, 0.707f);
+    hpf.current = hpf.target;
+    lpf.current = lpf.target;
+    hpf.ramping = lpf.ramping = false;
 }
 
-void Filters::setLPFParameters(float frequency, float resonance) {
-    currentLPFFrequency = frequency;
-    updateLPFCoefficients(currentLPFFrequency, resonance);
+template <typename SampleType>
+void Filters<SampleType>::setHPFParameters(float frequency, float resonance) {
+    if (frequency == hpf.frequency && resonance == hpf.resonance)
+        return;
+
+    updateHPFCoefficients(frequency, resonance);
+}
+
+template <typename SampleType>
+void Filters<SampleType>::setLPFParameters(float frequency, float resonance) {
+    if (frequency == lpf.frequency && resonance == lpf.resonance)
+        return;
+
+    updateLPFCoefficients(frequency, resonance);
+}
+
+template <typename SampleType>
+void Filters<SampleType>::prepare(int numChannels) {
+    const auto numGroups = (static_cast<size_t>(numChannels) + Lanes::size() - 1) / Lanes::size();
+    states.assign(numGroups, ChannelGroupState());
 }
 
-void Filters::process(AudioBuffer<float>& buffer) {
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
-        
-        // Applica il filtro HPF al canale con un parametro di transizione
-        hpf.setCoefficients(IIRCoefficients::makeHighPass(currentSampleRate, currentHPFFrequency, 0.707));
-        hpf.processSamples(buffer.getWritePointer(channel), buffer.getNumSamples());
+template <typename SampleType>
+void Filters<SampleType>::reset() {
+    std::fill(states.begin(), states.end(), ChannelGroupState());
+}
+
+template <typename SampleType>
+void Filters<SampleType>::process(AudioBuffer<SampleType>& buffer) {
+    const auto numChannels = buffer.getNumChannels();
+    const auto numSamples = buffer.getNumSamples();
+    const auto groupSize = static_cast<int>(Lanes::size());
+    auto* const* channels = buffer.getArrayOfWritePointers();
+
+    // Channels beyond what prepare() was told about have no state to run with.
+    jassert(numChannels <= static_cast<int>(states.size()) * groupSize);
+
+    if (numSamples <= 0)
+        return;
+
+    const auto ramping = hpf.ramping || lpf.ramping;
+
+    for (int first = 0, group = 0; first < numChannels && group < static_cast<int>(states.size()); first += groupSize, ++group) {
+        auto& state = states[static_cast<size_t>(group)];
+        const auto numChannelsInGroup = jmin(groupSize, numChannels - first);
+
+        if (ramping)
+            processGroup<true>(channels + first, numChannelsInGroup, numSamples, state);
+        else
+            processGroup<false>(channels + first, numChannelsInGroup, numSamples, state);
+    }
+
+    // Every group ramped from the same start, so the targets are only latched once all are done.
+    hpf.current = hpf.target;
+    lpf.current = lpf.target;
+    hpf.ramping = lpf.ramping = false;
+}
+
+template <typename SampleType>
+template <bool ramping>
+void Filters<SampleType>::processGroup(SampleType* const* channels, int numChannelsInGroup, int numSamples, ChannelGroupState& state) {
+    auto hb0 = Lanes::expand(hpf.current.b0), hb1 = Lanes::expand(hpf.current.b1), hb2 = Lanes::expand(hpf.current.b2);
+    auto ha1 = Lanes::expand(hpf.current.a1), ha2 = Lanes::expand(hpf.current.a2);
+    auto lb0 = Lanes::expand(lpf.current.b0), lb1 = Lanes::expand(lpf.current.b1), lb2 = Lanes::expand(lpf.current.b2);
+    auto la1 = Lanes::expand(lpf.current.a1), la2 = Lanes::expand(lpf.current.a2);
+
+    // Per-sample coefficient increments; only used (and only computed) while ramping
+    Coefficients hd, ld;
+
+    if (ramping) {
+        const auto scale = SampleType(1) / static_cast<SampleType>(numSamples);
+        hd = { (hpf.target.b0 - hpf.current.b0) * scale, (hpf.target.b1 - hpf.current.b1) * scale, (hpf.target.b2 - hpf.current.b2) * scale,
+               (hpf.target.a1 - hpf.current.a1) * scale, (hpf.target.a2 - hpf.current.a2) * scale };
+        ld = { (lpf.target.b0 - lpf.current.b0) * scale, (lpf.target.b1 - lpf.current.b1) * scale, (lpf.target.b2 - lpf.current.b2) * scale,
+               (lpf.target.a1 - lpf.current.a1) * scale, (lpf.target.a2 - lpf.current.a2) * scale };
+    }
+
+    auto hpf1 = state.hpf1, hpf2 = state.hpf2;
+    auto lpf1 = state.lpf1, lpf2 = state.lpf2;
+
+    alignas(Lanes::SIMDRegisterSize) SampleType frame[Lanes::size()] = {};
+
+    for (int i = 0; i < numSamples; ++i) {
+        if (ramping) {
+            hb0 += Lanes::expand(hd.b0); hb1 += Lanes::expand(hd.b1); hb2 += Lanes::expand(hd.b2);
+            ha1 += Lanes::expand(hd.a1); ha2 += Lanes::expand(hd.a2);
+            lb0 += Lanes::expand(ld.b0); lb1 += Lanes::expand(ld.b1); lb2 += Lanes::expand(ld.b2);
+            la1 += Lanes::expand(ld.a1); la2 += Lanes::expand(ld.a2);
+        }
 
-        // Applica il filtro LPF al canale con un parametro di transizione
-        lpf.setCoefficients(IIRCoefficients::makeLowPass(currentSampleRate, currentLPFFrequency, 0.707));
-        lpf.processSamples(buffer.getWritePointer(channel), buffer.getNumSamples());
+        for (int lane = 0; lane < numChannelsInGroup; ++lane)
+            frame[lane] = channels[lane][i];
+
+        const auto x = Lanes::fromRawArray(frame);
+
+        // Transposed direct form II, HPF then LPF, all lanes at once
+        const auto h = hb0 * x + hpf1;
+        hpf1 = hb1 * x - ha1 * h + hpf2;
+        hpf2 = hb2 * x - ha2 * h;
+
+        const auto y = lb0 * h + lpf1;
+        lpf1 = lb1 * h - la1 * y + lpf2;
+        lpf2 = lb2 * h - la2 * y;
+
+        y.copyToRawArray(frame);
+
+        for (int lane = 0; lane < numChannelsInGroup; ++lane)
+            channels[lane][i] = frame[lane];
     }
+
+    state.hpf1 = hpf1; state.hpf2 = hpf2;
+    state.lpf1 = lpf1; state.lpf2 = lpf2;
 }
 
-void Filters::updateHPFCoefficients(float frequency, float resonance) {
-    hpf.setCoefficients(IIRCoefficients::makeHighPass(currentSampleRate, frequency, resonance));
+// The float path takes its coefficients from the shared table, or from
+// IIRCoefficients off the table's resonance; both are float.
+template <typename SampleType>
+typename Filters<SampleType>::Coefficients Filters<SampleType>::fromIIRCoefficients(const IIRCoefficients& coefficients) {
+    const auto* c = coefficients.coefficients;
+    return { static_cast<SampleType>(c[0]), static_cast<SampleType>(c[1]), static_cast<SampleType>(c[2]),
+             static_cast<SampleType>(c[3]), static_cast<SampleType>(c[4]) };
 }
 
-void Filters::updateLPFCoefficients(float frequency, float resonance) {
-    lpf.setCoefficients(IIRCoefficients::makeLowPass(currentSampleRate, frequency, resonance));
+template <typename SampleType>
+typename Filters<SampleType>::Coefficients Filters<SampleType>::fromTableEntry(const FilterCoefficientTable::Coefficients& entry) {
+    return { static_cast<SampleType>(entry.b0), static_cast<SampleType>(entry.b1), static_cast<SampleType>(entry.b2),
+             static_cast<SampleType>(entry.a1), static_cast<SampleType>(entry.a2) };
+}
+
+// The double path designs its own, in double: widened float coefficients
+// put poles near z = 1 (low cutoffs, high rates) off by float rounding,
+// which is the error the 64-bit path exists to avoid. Same bilinear
+// designs as IIRCoefficients, normalised so a0 = 1.
+template <typename SampleType>
+typename Filters<SampleType>::Coefficients Filters<SampleType>::designHighPass(double sampleRate, double frequency, double resonance) {
+    const auto n = std::tan(MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+    const auto c1 = 1.0 / (1.0 + n / resonance + nSquared);
+
+    return { static_cast<SampleType>(c1), static_cast<SampleType>(c1 * -2.0), static_cast<SampleType>(c1),
+             static_cast<SampleType>(c1 * 2.0 * (nSquared - 1.0)), static_cast<SampleType>(c1 * (1.0 - n / resonance + nSquared)) };
+}
+
+template <typename SampleType>
+typename Filters<SampleType>::Coefficients Filters<SampleType>::designLowPass(double sampleRate, double frequency, double resonance) {
+    const auto n = 1.0 / std::tan(MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+    const auto c1 = 1.0 / (1.0 + n / resonance + nSquared);
+
+    return { static_cast<SampleType>(c1), static_cast<SampleType>(c1 * 2.0), static_cast<SampleType>(c1),
+             static_cast<SampleType>(c1 * 2.0 * (1.0 - nSquared)), static_cast<SampleType>(c1 * (1.0 - n / resonance + nSquared)) };
 }
 
-void Filters::setSampleRate(double sampleRate) {
+template <typename SampleType>
+void Filters<SampleType>::updateHPFCoefficients(float frequency, float resonance) {
+    hpf.frequency = frequency;
+    hpf.resonance = resonance;
+
+    if constexpr (std::is_same<SampleType, double>::value)
+        hpf.target = designHighPass(currentSampleRate, frequency, resonance);
+    else
+        hpf.target = resonance == FilterCoefficientTable::resonance
+                       ? fromTableEntry(coefficientTable->getHighPass(frequency, currentSampleRate))
+                       : fromIIRCoefficients(IIRCoefficients::makeHighPass(currentSampleRate, frequency, resonance));
+
+    hpf.ramping = true;
+}
+
+template <typename SampleType>
+void Filters<SampleType>::updateLPFCoefficients(float frequency, float resonance) {
+    lpf.frequency = frequency;
+    lpf.resonance = resonance;
+
+    if constexpr (std::is_same<SampleType, double>::value)
+        lpf.target = designLowPass(currentSampleRate, frequency, resonance);
+    else
+        lpf.target = resonance == FilterCoefficientTable::resonance
+                       ? fromTableEntry(coefficientTable->getLowPass(frequency, currentSampleRate))
+                       : fromIIRCoefficients(IIRCoefficients::makeLowPass(currentSampleRate, frequency, resonance));
+
+    lpf.ramping = true;
+}
+
+template <typename SampleType>
+void Filters<SampleType>::setSampleRate(double sampleRate) {
     currentSampleRate = sampleRate;
-    // Optionally update filter coefficients here if necessary
-}
\ No newline at end of file
+    reset();
+
+    // New stream: jump straight to the coefficients for this rate instead of ramping
+    updateHPFCoefficients(hpf.frequency, hpf.resonance);
+    updateLPFCoefficients(lpf.frequency, lpf.resonance);
+    hpf.current = hpf.target;
+    lpf.current = lpf.target;
+    hpf.ramping = lpf.ramping = false;
+}
+
+template class Filters<float>;
+template class Filters<double>;
@@ -11,24 +11,66 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "FilterCoefficientTable.h"
 
+// Templated on the sample type so the float and double processing paths
+// share one implementation; both are instantiated in Filters.cpp.
+template <typename SampleType>
 class Filters {
 public:
     Filters();
     Filters(double sampleRate);
 
+    // Cheap to call every block: coefficients are only looked up when the
+    // frequency or resonance actually changes, and the change is then ramped
+    // per sample across the next process() call.
     void setHPFParameters(float frequency, float resonance);
     void setLPFParameters(float frequency, float resonance);
-    void process(AudioBuffer<float>& buffer);
+
+    // Sizes the per-channel filter state; only allocates when numChannels
+    // exceeds every previous call.
+    void prepare(int numChannels);
+    void reset();
+    void process(AudioBuffer<SampleType>& buffer);
+
+    size_t getMemoryFootprintBytes() const noexcept { return states.capacity() * sizeof(ChannelGroupState); }
 
     void setSampleRate(double sampleRate);
 private:
-    float currentHPFFrequency;
-    float currentLPFFrequency;
+    // Channels are packed into the lanes of a SIMD register (L/R share one
+    // register on a stereo bus) so the HPF->LPF cascade runs once per sample
+    // for the whole group, while every lane keeps its own filter state.
+    using Lanes = dsp::SIMDRegister<SampleType>;
+
+    struct Coefficients {
+        SampleType b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+    };
+
+    struct Stage {
+        float frequency = 0.0f;
+        float resonance = 0.0f;
+        Coefficients current, target;
+        bool ramping = false;
+    };
+
+    struct ChannelGroupState {
+        Lanes hpf1 = Lanes::expand(0), hpf2 = Lanes::expand(0);
+        Lanes lpf1 = Lanes::expand(0), lpf2 = Lanes::expand(0);
+    };
 
     double currentSampleRate;
-    IIRFilter hpf, lpf;
+    Stage hpf, lpf;
+    SharedResourcePointer<FilterCoefficientTable> coefficientTable;
+    std::vector<ChannelGroupState> states;
 
     void updateHPFCoefficients(float frequency, float resonance);
     void updateLPFCoefficients(float frequency, float resonance);
+
+    template <bool ramping>
+    void processGroup(SampleType* const* channels, int numChannelsInGroup, int numSamples, ChannelGroupState& state);
+
+    static Coefficients fromIIRCoefficients(const IIRCoefficients& coefficients);
+    static Coefficients fromTableEntry(const FilterCoefficientTable::Coefficients& entry);
+    static Coefficients designHighPass(double sampleRate, double frequency, double resonance);
+    static Coefficients designLowPass(double sampleRate, double frequency, double resonance);
 };
@@ -0,0 +1,57 @@
+#include "ParameterSmoother.h"
+
+void ParameterSmoother::prepare(double sampleRate, double rampLengthSeconds, int maximumBlockSize) {
+    rampLength = jmax(1, roundToInt(sampleRate * rampLengthSeconds));
+
+    if (maximumBlockSize > rampCapacity) {
+        ramp.allocate(static_cast<size_t>(maximumBlockSize), true);
+        rampCapacity = maximumBlockSize;
+    }
+
+    setCurrentAndTargetValue(target);
+}
+
+void ParameterSmoother::setCurrentAndTargetValue(float newValue) noexcept {
+    current = target = newValue;
+    countdown = 0;
+}
+
+void ParameterSmoother::setTargetValue(float newTarget) noexcept {
+    if (newTarget == target)
+        return;
+
+    // Restart from wherever the previous ramp got to
+    target = newTarget;
+    countdown = rampLength;
+    rampStart = current;
+    rampPosition = 0;
+    step = (target - current) / static_cast<float>(rampLength);
+}
+
+bool ParameterSmoother::process(int numSamples) noexcept {
+    if (countdown <= 0)
+        return false;
+
+    jassert(numSamples <= rampCapacity);
+
+    const auto rampSamples = jmin(numSamples, countdown);
+
+    for (int i = 0; i < rampSamples; ++i)
+        ramp[i] = rampStart + step * static_cast<float>(rampPosition + i + 1);
+
+    if (rampSamples < numSamples)
+        FloatVectorOperations::fill(ramp.get() + rampSamples, target, numSamples - rampSamples);
+
+    skip(numSamples);
+    return true;
+}
+
+void ParameterSmoother::skip(int numSamples) noexcept {
+    if (countdown <= 0)
+        return;
+
+    const auto rampSamples = jmin(numSamples, countdown);
+    countdown -= rampSamples;
+    rampPosition += rampSamples;
+    current = countdown > 0 ? rampStart + step * static_cast<float>(rampPosition) : target;
+}
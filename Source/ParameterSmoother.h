@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    ParameterSmoother.h
+    Linear parameter ramps generated a block at a time into a preallocated
+    buffer, with a fast path that does no per-sample work once settled.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class ParameterSmoother {
+public:
+    ParameterSmoother() = default;
+
+    // Sets the ramp length; the ramp buffer is only (re)allocated when
+    // maximumBlockSize exceeds every previous call.
+    void prepare(double sampleRate, double rampLengthSeconds, int maximumBlockSize);
+
+    void setCurrentAndTargetValue(float newValue) noexcept;
+    void setTargetValue(float newTarget) noexcept;
+
+    // Advances by numSamples. Returns false when settled, in which case
+    // getTargetValue() holds for the whole block and no ramp was written;
+    // otherwise getRamp() holds one value per sample of the block.
+    bool process(int numSamples) noexcept;
+
+    // Advances by numSamples without writing a ramp, for consumers that only
+    // need the value reached at the end of the block.
+    void skip(int numSamples) noexcept;
+
+    bool isSmoothing() const noexcept { return countdown > 0; }
+    const float* getRamp() const noexcept { return ramp.get(); }
+    float getCurrentValue() const noexcept { return current; }
+    float getTargetValue() const noexcept { return target; }
+
+    size_t getMemoryFootprintBytes() const noexcept { return static_cast<size_t>(rampCapacity) * sizeof(float); }
+
+private:
+    HeapBlock<float> ramp;
+    int rampCapacity = 0;
+    int rampLength = 1;
+    int countdown = 0;
+    float current = 0.0f;
+    float target = 0.0f;
+    float step = 0.0f;
+
+    // Ramp values are computed from where the ramp started rather than
+    // accumulated, so the result doesn't depend on how the host slices blocks
+    float rampStart = 0.0f;
+    int rampPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterSmoother)
+};
@@ -55,8 +55,18 @@ XyPadAudioProcessorEditor::XyPadAudioProcessorEditor(XyPadAudioProcessor& p) :
 
     addAndMakeVisible(hpfLpfSlider);
 
-    // Imposta la dimensione dell'editor
-     setSize(500, 300);
+    loadLabel.setFont(juce::Font(12.0f));
+    loadLabel.setJustificationType(juce::Justification::centredLeft);
+    addAndMakeVisible(loadLabel);
+    startTimerHz(4);
+
+   #if XYPAD_TRACE
+    saveTraceButton.onClick = [this] { saveTrace(); };
+    addAndMakeVisible(saveTraceButton);
+   #endif
+
+    // Imposta la dimensione dell'editor; the DSP load readout gets its own strip below
+     setSize(500, 300 + loadLabelHeight);
 }
 
 XyPadAudioProcessorEditor::~XyPadAudioProcessorEditor()
@@ -68,6 +78,7 @@ XyPadAudioProcessorEditor::~XyPadAudioProcessorEditor()
 //==============================================================================
 void XyPadAudioProcessorEditor::paint (juce::Graphics& g)
 {
+    XYPAD_TRACE_SCOPE("Editor::paint");
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));    
 }
 void XyPadAudioProcessorEditor::resized()
@@ -83,7 +94,9 @@ void XyPadAudioProcessorEditor::resized()
     // setResizable(true, true);
     // setResizeLimits(400, 300, 800, 600); 
 
-    auto bounds = getLocalBounds().reduced(20);
+    auto bounds = getLocalBounds();
+    auto loadBounds = bounds.removeFromBottom(loadLabelHeight).reduced(horizontalSpace, 0);
+    bounds = bounds.reduced(20);
 
     
     auto widthForDelaySlider = bounds.proportionOfWidth(0.25f);
@@ -114,10 +127,59 @@ void XyPadAudioProcessorEditor::resized()
     const int textBoxHeight = 20; 
     delayTimeSlider.setTextBoxStyle(juce::Slider::TextBoxAbove, false, labelWidth, textBoxHeight);
     dryWetMixSlider.setTextBoxStyle(juce::Slider::TextBoxAbove, false, labelWidth, textBoxHeight);
+
+    loadLabel.setBounds(loadBounds);
+
+   #if XYPAD_TRACE
+    saveTraceButton.setBounds(getWidth() - horizontalSpace - labelWidth, 5, labelWidth, labelHeight);
+   #endif
+}
+
+#if XYPAD_TRACE
+void XyPadAudioProcessorEditor::saveTrace()
+{
+    // Next to the user's documents, named by time so successive dumps don't collide
+    const auto file = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                          .getChildFile("XyPad-trace-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".json");
+
+    const auto result = traceSession->writeChromeTrace(file);
+    juce::AlertWindow::showMessageBoxAsync(result.wasOk() ? juce::MessageBoxIconType::InfoIcon : juce::MessageBoxIconType::WarningIcon, "Trace",
+                                           result.wasOk() ? "Saved to " + file.getFullPathName() : result.getErrorMessage());
+}
+#endif
+
+void XyPadAudioProcessorEditor::timerCallback()
+{
+    XYPAD_TRACE_SCOPE("Editor::timerCallback");
+
+    using Stage = DspLoadMeter::Stage;
+
+    const auto report = audioProcessor.getLoadMeter().getReport();
+
+    if (report.numBlocks == 0)
+    {
+        loadLabel.setText("DSP: -", juce::dontSendNotification);
+        return;
+    }
+
+    const auto& total = report.stages[static_cast<size_t>(Stage::total)];
+    const auto load = [&report](Stage stage) { return juce::String(report.stages[static_cast<size_t>(stage)].averageLoad, 1) + "%"; };
+
+    // Totals on the first line, the per-stage split on the second. Times in
+    // microseconds, loads as a share of the real-time budget
+    loadLabel.setText("DSP " + load(Stage::total)
+                      + " (peak " + juce::String(total.peakLoad, 1) + "%)"
+                      + "  min/avg/p99/max " + juce::String(total.minimum, 0) + "/" + juce::String(total.average, 0)
+                      + "/" + juce::String(total.p99, 0) + "/" + juce::String(total.maximum, 0) + " us\n"
+                      + "filter " + load(Stage::filter) + "  delay " + load(Stage::delay) + "  mix " + load(Stage::mix),
+                      juce::dontSendNotification);
 }
 
 void XyPadAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
 {
+    // This is where the editor writes the filter parameters
+    XYPAD_TRACE_SCOPE("Editor::sliderValueChanged");
+
     if (slider == &hpfLpfSlider) 
     {
         auto hpfFreq = hpfLpfSlider.getMinValue();
@@ -15,7 +15,7 @@
 //==============================================================================
 /**
 */
-class XyPadAudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Slider::Listener
+class XyPadAudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Slider::Listener, private juce::Timer
 {
 public:
     XyPadAudioProcessorEditor (XyPadAudioProcessor&);
@@ -27,6 +27,7 @@ public:
 
     void sliderValueChanged(juce::Slider* slider) override;
 private:
+    void timerCallback() override;
 
     using SliderAttachment = AudioProcessorValueTreeState::SliderAttachment;
 	
@@ -46,5 +47,16 @@ private:
     Label delayDisplayLabel{ "delayDisplayLabel", "DelayLRms" };
     Gui::XyPad xyPad;
 
+    // DSP load of this instance, refreshed a few times a second, in a
+    // two-line strip along the bottom of the editor
+    juce::Label loadLabel;
+    static constexpr int loadLabelHeight = 40;
+
+   #if XYPAD_TRACE
+    juce::SharedResourcePointer<TraceSession> traceSession;
+    juce::TextButton saveTraceButton { "Save trace" };
+    void saveTrace();
+   #endif
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (XyPadAudioProcessorEditor)
 };
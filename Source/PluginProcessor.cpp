@@ -10,10 +10,113 @@ XyPadAudioProcessor::XyPadAudioProcessor() :
     std::make_unique<AudioParameterFloat>("delayTime", "Delay Time", NormalisableRange<float>(-17.5f, 17.5f, 0.01f), 0.f),
     std::make_unique<AudioParameterFloat>("dryWetMix", "Dry/Wet Mix", NormalisableRange<float>(0.f, 1.f, 0.01f), 0.5f),
     std::make_unique<AudioParameterFloat>("hpfFrequency", "HPF Frequency", NormalisableRange<float>(20.0f, 20000.0f, 1.0f), 440.0f),
-    std::make_unique<AudioParameterFloat>("lpfFrequency", "LPF Frequency", NormalisableRange<float>(20.0f, 20000.0f, 1.0f), 5000.0f)
+    std::make_unique<AudioParameterFloat>("lpfFrequency", "LPF Frequency", NormalisableRange<float>(20.0f, 20000.0f, 1.0f), 5000.0f),
+    std::make_unique<AudioParameterChoice>("delayInterpolation", "Delay Interpolation", StringArray { "Linear", "Lagrange", "Thiran" }, 0),
+    std::make_unique<AudioParameterChoice>("delayMode", "Delay Mode", StringArray { "Haas", "Long" }, 0),
+    std::make_unique<AudioParameterFloat>("feedback", "Feedback", NormalisableRange<float>(0.0f, 0.95f, 0.01f), 0.35f),
+    std::make_unique<AudioParameterBool>("tempoSync", "Tempo Sync", false),
+    std::make_unique<AudioParameterBool>("bypass", "Bypass", false)
     })
 {
+    delayTimeParameter = parameters.getRawParameterValue("delayTime");
+    dryWetMixParameter = parameters.getRawParameterValue("dryWetMix");
+    hpfFrequencyParameter = parameters.getRawParameterValue("hpfFrequency");
+    lpfFrequencyParameter = parameters.getRawParameterValue("lpfFrequency");
+    delayInterpolationParameter = parameters.getRawParameterValue("delayInterpolation");
+    delayModeParameter = parameters.getRawParameterValue("delayMode");
+    feedbackParameter = parameters.getRawParameterValue("feedback");
+    tempoSyncParameter = parameters.getRawParameterValue("tempoSync");
+    bypassParameter = parameters.getRawParameterValue("bypass");
 
+    resetSpeakerDelayWeights();
+    allocateForMaximumConfiguration();
+}
+
+void XyPadAudioProcessor::allocateForMaximumConfiguration()
+{
+    // All audio-path storage is sized here, for the largest sample rate and
+    // the longest delay we accept on the current layout. prepareToPlay only
+    // carves smaller views out of it, so hosts can change rate or block size
+    // without the plugin touching the heap. A layout change reallocates, but
+    // hosts only do that while the plugin is inactive, off the audio thread.
+    // Only the chain for the precision the host asked for holds any memory.
+    // The price is paid at every rate: the line rounds up to 1M samples per
+    // channel, about 8 MB for stereo float and 100 MB for 7.1.4 in double,
+    // most of it for Long mode. The benchmark prints it per layout.
+    const auto numChannels = juce::jlimit(1, maximumNumChannels, getTotalNumInputChannels());
+    const auto maxDelayInSamples = static_cast<int>(std::ceil(maximumSampleRate * maximumLongDelayMs / 1000.0));
+
+    chainIsDouble = isUsingDoublePrecision();
+
+    if (chainIsDouble)
+    {
+        floatChain.release();
+        doubleChain.allocate(numChannels, maxDelayInSamples, subBlockSize);
+    }
+    else
+    {
+        doubleChain.release();
+        floatChain.allocate(numChannels, maxDelayInSamples, subBlockSize);
+    }
+
+    delayTimes.allocate(static_cast<size_t>(subBlockSize), true);
+
+    for (auto* smoother : { &delayTimeSmoother, &dryWetSmoother, &hpfSmoother, &lpfSmoother, &feedbackSmoother, &bypassSmoother })
+        smoother->prepare(maximumSampleRate, 0.0, subBlockSize);
+}
+
+size_t XyPadAudioProcessor::getMemoryFootprintBytes() const noexcept
+{
+    const auto delayTimeBytes = static_cast<size_t>(subBlockSize) * sizeof(float);
+
+    return floatChain.getMemoryFootprintBytes()
+         + doubleChain.getMemoryFootprintBytes()
+         + delayTimeBytes
+         + delayTimeSmoother.getMemoryFootprintBytes()
+         + dryWetSmoother.getMemoryFootprintBytes()
+         + hpfSmoother.getMemoryFootprintBytes()
+         + lpfSmoother.getMemoryFootprintBytes()
+         + feedbackSmoother.getMemoryFootprintBytes()
+         + bypassSmoother.getMemoryFootprintBytes();
+}
+
+template <typename SampleType>
+void XyPadAudioProcessor::ProcessingChain<SampleType>::allocate(int numChannels, int maxDelayInSamples, int maxBlockSize)
+{
+    filters.prepare(numChannels);
+    delayLine.allocate(numChannels, maxDelayInSamples, maxBlockSize);
+    wetBuffer.setSize(numChannels, maxBlockSize);
+    feedbackBuffer.setSize(numChannels, maxBlockSize);
+    dryBuffer.setSize(numChannels, maxBlockSize);
+}
+
+template <typename SampleType>
+void XyPadAudioProcessor::ProcessingChain<SampleType>::release()
+{
+    delayLine.release();
+    wetBuffer.setSize(0, 0);
+    feedbackBuffer.setSize(0, 0);
+    dryBuffer.setSize(0, 0);
+}
+
+template <typename SampleType>
+void XyPadAudioProcessor::ProcessingChain<SampleType>::prepare(int numChannels, int maxDelayInSamples, int maxBlockSize)
+{
+    filters.prepare(numChannels);
+    delayLine.prepare(numChannels, maxDelayInSamples, maxBlockSize);
+    wetBuffer.setSize(numChannels, maxBlockSize, false, false, true);
+    feedbackBuffer.setSize(numChannels, maxBlockSize, false, false, true);
+    dryBuffer.setSize(numChannels, maxBlockSize, false, false, true);
+}
+
+template <typename SampleType>
+size_t XyPadAudioProcessor::ProcessingChain<SampleType>::getMemoryFootprintBytes() const noexcept
+{
+    const auto scratchSamples = static_cast<size_t>(wetBuffer.getNumChannels() * wetBuffer.getNumSamples()
+                                                    + feedbackBuffer.getNumChannels() * feedbackBuffer.getNumSamples()
+                                                    + dryBuffer.getNumChannels() * dryBuffer.getNumSamples());
+
+    return filters.getMemoryFootprintBytes() + delayLine.getMemoryFootprintBytes() + scratchSamples * sizeof(SampleType);
 }
 
 XyPadAudioProcessor::~XyPadAudioProcessor()
@@ -56,7 +159,55 @@ bool XyPadAudioProcessor::isMidiEffect() const
 
 double XyPadAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return getTailLengthSeconds(readParameters());
+}
+
+double XyPadAudioProcessor::getTailLengthSeconds(const ParameterSnapshot& snapshot) const
+{
+    // The host thread can't know the synced repeat time, so it gets the longest one
+    const auto delayTimeValue = snapshot.tempoSync && snapshot.delayMode == longDelayMode ? 17.5f : snapshot.delayTime;
+    const auto seconds = getTailLengthSeconds(snapshot.delayMode, delayTimeValue, snapshot.feedback,
+                                              snapshot.hpfFrequency, snapshot.lpfFrequency, hostTailThreshold);
+
+    return juce::jmin(seconds, maximumHostTailSeconds);
+}
+
+double XyPadAudioProcessor::getTailLengthSeconds(int delayMode, float delayTimeValue, float feedback, float hpfFrequency, float lpfFrequency, float threshold) const
+{
+    // From the last input sample until a full-scale input has fallen below
+    // threshold: the longest delay the pad reaches, in Long mode as many
+    // repeats as the feedback needs to fall that far, then the filters
+    // ringing out.
+    const auto filterSeconds = getFilterRingSeconds(hpfFrequency, threshold) + getFilterRingSeconds(lpfFrequency, threshold);
+    const auto padAmount = juce::jlimit(0.0f, 1.0f, std::abs(delayTimeValue) / 17.5f);
+
+    if (delayMode != longDelayMode)
+        return padAmount * maximumDelayTimeMs / 1000.0 + filterSeconds;
+
+    const auto repeatSeconds = juce::jmax(minimumLongDelayMs, padAmount * maximumLongDelayMs) / 1000.0;
+    const auto repeats = feedback > 0.0f ? std::ceil(std::log(static_cast<double>(threshold)) / std::log(static_cast<double>(feedback)))
+                                         : 1.0;
+
+    return repeats * repeatSeconds + filterSeconds;
+}
+
+double XyPadAudioProcessor::getCurrentTailLengthSeconds() const
+{
+    // Audio thread only: the smoothers already hold the synced repeat time
+    const auto delayTimeValue = juce::jmax(std::abs(delayTimeSmoother.getCurrentValue()), std::abs(delayTimeSmoother.getTargetValue()));
+    const auto feedback = juce::jmax(feedbackSmoother.getCurrentValue(), feedbackSmoother.getTargetValue());
+    const auto hpfFrequency = juce::jmin(hpfSmoother.getCurrentValue(), hpfSmoother.getTargetValue());
+    const auto lpfFrequency = juce::jmin(lpfSmoother.getCurrentValue(), lpfSmoother.getTargetValue());
+
+    return getTailLengthSeconds(currentDelayMode, delayTimeValue, feedback, hpfFrequency, lpfFrequency, silenceThreshold);
+}
+
+double XyPadAudioProcessor::getFilterRingSeconds(float frequency, float threshold)
+{
+    // A Q of 0.707 biquad decays as exp(-w t / (2 Q)), so a 20 Hz high-pass
+    // takes about 150 ms to fall by 120 dB
+    const auto decayRate = juce::MathConstants<double>::twoPi * juce::jmax(1.0f, frequency) / (2.0 * 0.707);
+    return -std::log(static_cast<double>(threshold)) / decayRate;
 }
 
 int XyPadAudioProcessor::getNumPrograms()
@@ -86,29 +237,86 @@ void XyPadAudioProcessor::changeProgramName (int index, const juce::String& newN
 //==============================================================================
 void XyPadAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    filters.setSampleRate(sampleRate);
+    const auto numChannels = getTotalNumInputChannels();
+    const auto snapshot = readParameters();
 
-    const double maxDelayTimeMs = 35.0;
-    delayBufferLength = static_cast<int>(sampleRate * maxDelayTimeMs / 1000.0);
+    // Everything below is sized for one internal sub-block, whatever the host
+    // block size, and reuses the storage allocated for the layout
+    juce::ignoreUnused(samplesPerBlock);
+    jassert(sampleRate <= maximumSampleRate && numChannels <= maximumNumChannels);
 
-    if (delayBuffer.getNumChannels() != getTotalNumInputChannels() || delayBuffer.getNumSamples() != delayBufferLength)
-    {
-        delayBuffer.setSize(getTotalNumInputChannels(), delayBufferLength);
-        delayBuffer.clear(); 
-        delayWritePosition = 0;
-    }
+    // Hosts choose the processing precision before activating the plugin;
+    // a change is the only other thing that reallocates
+    if (isUsingDoublePrecision() != chainIsDouble)
+        allocateForMaximumConfiguration();
+
+    // Always long enough for the long mode, so switching modes never reallocates
+    const auto maxDelayInSamples = static_cast<int>(std::ceil(sampleRate * maximumLongDelayMs / 1000.0));
+
+    if (chainIsDouble)
+        prepareChain(doubleChain, numChannels, maxDelayInSamples, sampleRate, snapshot);
+    else
+        prepareChain(floatChain, numChannels, maxDelayInSamples, sampleRate, snapshot);
+
+    // Start from the current values so activation doesn't glide in from zero
+    delayTimeSmoother.prepare(sampleRate, delaySmoothingSeconds, subBlockSize);
+    dryWetSmoother.prepare(sampleRate, mixSmoothingSeconds, subBlockSize);
+    hpfSmoother.prepare(sampleRate, filterSmoothingSeconds, subBlockSize);
+    lpfSmoother.prepare(sampleRate, filterSmoothingSeconds, subBlockSize);
+    feedbackSmoother.prepare(sampleRate, mixSmoothingSeconds, subBlockSize);
+    bypassSmoother.prepare(sampleRate, bypassFadeSeconds, subBlockSize);
+
+    delayTimeSmoother.setCurrentAndTargetValue(getDelayTimeTarget(snapshot));
+    dryWetSmoother.setCurrentAndTargetValue(snapshot.dryWetMix);
+    hpfSmoother.setCurrentAndTargetValue(snapshot.hpfFrequency);
+    lpfSmoother.setCurrentAndTargetValue(snapshot.lpfFrequency);
+    feedbackSmoother.setCurrentAndTargetValue(snapshot.feedback);
+    bypassSmoother.setCurrentAndTargetValue(snapshot.bypass ? 1.0f : 0.0f);
+    currentDelayMode = snapshot.delayMode;
+    bypassWarmUpRemaining = 0;
+    filteredSamplesInLine = getHaasDelayInSamples();
+    silentSamples = 0;
+    outputWasSilent = false;
+    idle = false;
+    idleSamplesToClear = 0;
+
+    layoutKernel = numChannels == 1 ? ChannelKernel::mono
+                 : numChannels == 2 ? ChannelKernel::stereo
+                                    : ChannelKernel::any;
+}
+
+template <typename SampleType>
+void XyPadAudioProcessor::prepareChain(ProcessingChain<SampleType>& chain, int numChannels, int maxDelayInSamples, double sampleRate, const ParameterSnapshot& snapshot)
+{
+    chain.prepare(numChannels, maxDelayInSamples, subBlockSize);
+
+    chain.filters.setHPFParameters(snapshot.hpfFrequency, 0.707f);
+    chain.filters.setLPFParameters(snapshot.lpfFrequency, 0.707f);
+    chain.filters.setSampleRate(sampleRate);
 }
 
 void XyPadAudioProcessor::releaseResources()
 {
-     delayBuffer.setSize(0, 0);    
+    // Storage is kept for the lifetime of the processor so the next
+    // prepareToPlay doesn't have to allocate
+    floatChain.delayLine.reset();
+    doubleChain.delayLine.reset();
+    silentSamples = 0;
+    outputWasSilent = false;
+    idle = false;
+    idleSamplesToClear = 0;
 }
 
 
 bool XyPadAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-        && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    const auto output = layouts.getMainOutputChannelSet();
+
+    if (output != juce::AudioChannelSet::mono()
+        && output != juce::AudioChannelSet::stereo()
+        && output != juce::AudioChannelSet::create5point1()
+        && output != juce::AudioChannelSet::create7point1()
+        && output != juce::AudioChannelSet::create7point1point4())
         return false;
 
     return layouts.getMainOutputChannelSet() == layouts.getMainInputChannelSet();
@@ -116,76 +324,705 @@ bool XyPadAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) con
 
 
 void XyPadAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    jassert(! chainIsDouble);
+    processBlockWithChain(buffer, floatChain, false);
+}
+
+void XyPadAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    jassert(chainIsDouble);
+    processBlockWithChain(buffer, doubleChain, false);
+}
+
+void XyPadAudioProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // Hosts that bypass without going through the parameter get the same warm bypass
+    juce::ignoreUnused(midiMessages);
+    jassert(! chainIsDouble);
+    processBlockWithChain(buffer, floatChain, true);
+}
+
+void XyPadAudioProcessor::processBlockBypassed(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    jassert(chainIsDouble);
+    processBlockWithChain(buffer, doubleChain, true);
+}
+
+juce::AudioProcessorParameter* XyPadAudioProcessor::getBypassParameter() const
+{
+    return parameters.getParameter("bypass");
+}
+
+bool XyPadAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+template <typename SampleType>
+void XyPadAudioProcessor::processBlockWithChain(juce::AudioBuffer<SampleType>& buffer, ProcessingChain<SampleType>& chain, bool hostBypassed)
 {
     juce::ScopedNoDenormals noDenormals;
-  
 
-    auto delayTimeValue = parameters.getRawParameterValue("delayTime")->load();
-    auto dryWetValue = parameters.getRawParameterValue("dryWetMix")->load();
-    auto hpfFreq = parameters.getRawParameterValue("hpfFrequency")->load();
-    auto lpfFreq = parameters.getRawParameterValue("lpfFrequency")->load();
+    const auto numSamples = buffer.getNumSamples();
+    const auto numChannels = juce::jmin(getTotalNumInputChannels(), buffer.getNumChannels());
 
-    DBG("Delay Time Value: " << delayTimeValue << ", Dry/Wet Value: " << dryWetValue
-        << ", HPF Frequency: " << hpfFreq << ", LPF Frequency: " << lpfFreq);
-    
-    filters.setHPFParameters(hpfFreq, 0.707f); 
-    filters.setLPFParameters(lpfFreq, 0.707f);
-    filters.process(buffer);
+    const auto snapshot = readParameters();
 
-    for (int channel = 0; channel < getTotalNumInputChannels(); ++channel)
+    DspLoadMeter::ScopedBlock timedBlock(loadMeter, numSamples, getSampleRate());
+
+    RT_LOG_DEBUG(rtLog, "delayTime, dryWetMix, hpfFrequency, lpfFrequency",
+                 snapshot.delayTime, snapshot.dryWetMix, snapshot.hpfFrequency, snapshot.lpfFrequency);
+
+    // The filters move between the input and the feedback loop, and the line
+    // holds repeats the other mode has no use for. Rather than clearing
+    // either on the audio thread, a switch fades out like a bypass, changes
+    // mode once the output is dry, and comes back in the way bypass
+    // disengages: filters from rest and, in Haas mode, a refilled line.
+    if (snapshot.delayMode != currentDelayMode && bypassSmoother.getTargetValue() == 1.0f && ! bypassSmoother.isSmoothing())
     {
-        auto* channelData = buffer.getWritePointer(channel);
-        auto* delayData = delayBuffer.getWritePointer(channel);
-        delayData[delayWritePosition % delayBufferLength] = 0.0f;
-
-        int delayTimeInSamples = getChannelSpecificDelayTime(channel, delayTimeValue, 35.0f, getSampleRate());
-        DBG("Channel: " << channel << ", Delay Time in Samples: " << delayTimeInSamples);
-      
-        if (delayTimeInSamples > 0)
+        currentDelayMode = snapshot.delayMode;
+        chain.filters.reset();
+        filteredSamplesInLine = 0;
+        RT_LOG_INFO(rtLog, "delay mode switched to", currentDelayMode);
+    }
+
+    if (snapshot.tempoSync)
+        updateHostTempo();
+
+    delayTimeSmoother.setTargetValue(getDelayTimeTarget(snapshot));
+    dryWetSmoother.setTargetValue(snapshot.dryWetMix);
+    hpfSmoother.setTargetValue(snapshot.hpfFrequency);
+    lpfSmoother.setTargetValue(snapshot.lpfFrequency);
+    feedbackSmoother.setTargetValue(snapshot.feedback);
+    chain.delayLine.setInterpolation(static_cast<typename DelayLine<SampleType>::Interpolation>(snapshot.delayInterpolation));
+
+    const auto bypassed = snapshot.bypass || hostBypassed || snapshot.delayMode != currentDelayMode;
+
+    // In Long mode the filters sit in the feedback loop, which didn't run
+    // while bypassed, so they come back from rest. In Haas mode they kept
+    // running and the line is warm, so the fade starts at once; after a mode
+    // switch the output stays dry until the chain has refilled what the Haas
+    // delay reaches.
+    if (! bypassed && bypassSmoother.getTargetValue() == 1.0f && ! bypassSmoother.isSmoothing())
+    {
+        if (currentDelayMode == longDelayMode)
+            chain.filters.reset();
+        else
+            bypassWarmUpRemaining = juce::jmax(0, getHaasDelayInSamples() - filteredSamplesInLine);
+    }
+
+    if (bypassed)
+        bypassWarmUpRemaining = 0;
+
+    if (bypassSmoother.getTargetValue() != (bypassed ? 1.0f : 0.0f))
+        RT_LOG_INFO(rtLog, bypassed ? "bypass engaging" : "bypass disengaging");
+
+    bypassSmoother.setTargetValue(bypassed ? 1.0f : 0.0f);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        blockDelayWeights[static_cast<size_t>(channel)] = speakerDelayWeights[static_cast<size_t>(channel)].load(std::memory_order_relaxed);
+
+    // Silence out of a drained chain is silence, so an idle block costs one
+    // pass over the input. Only silence before this block counts: what is
+    // still in the line comes out during it, however long the block is. The
+    // tail is worked out from wherever the smoothers are heading or coming
+    // from, but the line still holds older audio further back, which a pad
+    // move while idle would bring into reach. So idle blocks keep writing
+    // silence, a block at a time, until everything any mode can reach has
+    // been overwritten, and only then leave the line alone.
+    const auto silentBeforeBlock = silentSamples;
+    silentSamples = isSilent(buffer, numChannels) ? silentSamples + numSamples : 0;
+
+    if (silentSamples > 0 && outputWasSilent
+        && silentBeforeBlock > static_cast<juce::int64>(getCurrentTailLengthSeconds() * getSampleRate()))
+    {
+        if (! idle)
         {
-            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            idle = true;
+            chain.filters.reset();
+            idleSamplesToClear = static_cast<int>(std::ceil(maximumLongDelayMs * getSampleRate() / 1000.0)) + subBlockSize;
+            RT_LOG_INFO(rtLog, "idle after silent samples", silentBeforeBlock);
+        }
+
+        if (idleSamplesToClear > 0)
+        {
+            const auto numToClear = juce::jmin(numSamples, idleSamplesToClear);
+            chain.delayLine.writeSilence(numToClear);
+            idleSamplesToClear -= numToClear;
+        }
+
+        // Parameter moves while idle take effect at once rather than ramping on wake-up
+        snapSmoothers();
+        return;
+    }
+
+    if (idle)
+    {
+        idle = false;
+        RT_LOG_INFO(rtLog, "waking from idle");
+    }
+
+    // Run the whole chain over cache-sized slices of the host block. This keeps
+    // the scratch buffers and the delay storage independent of the host block
+    // size, so huge offline blocks neither overrun the ring nor thrash the cache.
+    auto* const* channels = buffer.getArrayOfWritePointers();
+    const auto channelKernel = getChannelKernel(numChannels);
+
+    for (int offset = 0; offset < numSamples; offset += subBlockSize)
+    {
+        juce::AudioBuffer<SampleType> subBlock(channels, numChannels, offset, juce::jmin(subBlockSize, numSamples - offset));
+
+        if (bypassSmoother.getTargetValue() == 1.0f && ! bypassSmoother.isSmoothing())
+        {
+            processBypassedSubBlock(subBlock, chain);
+            continue;
+        }
+
+        // Engaging or disengaging: keep the input to fade against
+        const auto fading = bypassSmoother.isSmoothing() || bypassWarmUpRemaining > 0;
+
+        if (fading)
+            for (int channel = 0; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::copy(chain.dryBuffer.getWritePointer(channel), subBlock.getReadPointer(channel), subBlock.getNumSamples());
+
+        // Smoothers settle part way through a block, so each sub-block picks again
+        const auto kernel = selectKernel<SampleType>(channelKernel);
+        (this->*kernel)(subBlock, chain);
+
+        if (currentDelayMode != longDelayMode)
+            filteredSamplesInLine = juce::jmin(getHaasDelayInSamples(), filteredSamplesInLine + subBlock.getNumSamples());
+
+        if (bypassWarmUpRemaining > 0)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::copy(subBlock.getWritePointer(channel), chain.dryBuffer.getReadPointer(channel), subBlock.getNumSamples());
+
+            bypassWarmUpRemaining = juce::jmax(0, bypassWarmUpRemaining - subBlock.getNumSamples());
+        }
+        else if (fading && bypassSmoother.process(subBlock.getNumSamples()))
+        {
+            DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::mix);
+            const auto* fade = bypassSmoother.getRamp();
+
+            for (int channel = 0; channel < numChannels; ++channel)
             {
-                const int localDelayReadPos = (delayWritePosition - delayTimeInSamples + delayBufferLength) % delayBufferLength;
-                delayData[delayWritePosition] = channelData[i];
+                auto* output = subBlock.getWritePointer(channel);
+                const auto* dry = chain.dryBuffer.getReadPointer(channel);
 
-                float wetSignal = delayData[localDelayReadPos];
-                float drySignal = channelData[i];
-                channelData[i] = drySignal * (1.0f - dryWetValue) + wetSignal * dryWetValue;
+                for (int i = 0; i < subBlock.getNumSamples(); ++i)
+                    output[i] += (dry[i] - output[i]) * static_cast<SampleType>(fade[i]);
             }
         }
-        else
+    }
+
+    // Silent input alone is not enough: feedback can still be ringing
+    outputWasSilent = silentSamples > 0 && isSilent(buffer, numChannels);
+}
+
+template <typename SampleType>
+void XyPadAudioProcessor::processBypassedSubBlock(juce::AudioBuffer<SampleType>& block, ProcessingChain<SampleType>& chain)
+{
+    // The input passes through untouched. The delay line is kept written,
+    // so re-engaging plays current audio, and the parameters jump to where
+    // the fade back in will pick them up. In Haas mode the line holds the
+    // filtered input, so the filters run into the wet scratch buffer and
+    // that is written; Long mode only needs the raw input.
+    const auto numSamples = block.getNumSamples();
+    snapSmoothers();
+
+    if (currentDelayMode == longDelayMode)
+    {
+        DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::delay);
+        chain.delayLine.write(block, numSamples);
+        chain.delayLine.advance(numSamples);
+        return;
+    }
+
+    juce::AudioBuffer<SampleType> filtered(chain.wetBuffer.getArrayOfWritePointers(), block.getNumChannels(), numSamples);
+
+    {
+        DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::filter);
+
+        for (int channel = 0; channel < block.getNumChannels(); ++channel)
+            juce::FloatVectorOperations::copy(filtered.getWritePointer(channel), block.getReadPointer(channel), numSamples);
+
+        chain.filters.setHPFParameters(hpfSmoother.getTargetValue(), 0.707f);
+        chain.filters.setLPFParameters(lpfSmoother.getTargetValue(), 0.707f);
+        chain.filters.process(filtered);
+    }
+
+    DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::delay);
+    chain.delayLine.write(filtered, numSamples);
+    chain.delayLine.advance(numSamples);
+    filteredSamplesInLine = juce::jmin(getHaasDelayInSamples(), filteredSamplesInLine + numSamples);
+}
+
+int XyPadAudioProcessor::getHaasDelayInSamples() const
+{
+    return static_cast<int>(std::ceil(maximumDelayTimeMs * getSampleRate() / 1000.0));
+}
+
+void XyPadAudioProcessor::snapSmoothers()
+{
+    for (auto* smoother : { &delayTimeSmoother, &dryWetSmoother, &hpfSmoother, &lpfSmoother, &feedbackSmoother, &bypassSmoother })
+        smoother->setCurrentAndTargetValue(smoother->getTargetValue());
+}
+
+template <typename SampleType>
+bool XyPadAudioProcessor::isSilent(const juce::AudioBuffer<SampleType>& buffer, int numChannels)
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+        if (buffer.getMagnitude(channel, 0, buffer.getNumSamples()) > static_cast<SampleType>(silenceThreshold))
+            return false;
+
+    return true;
+}
+
+XyPadAudioProcessor::ChannelKernel XyPadAudioProcessor::getChannelKernel(int numChannels) const noexcept
+{
+    // The mono and stereo kernels hard-code the default speaker weights;
+    // custom weights, or a host passing fewer channels than the bus has,
+    // take the general one
+    if (layoutKernel == ChannelKernel::mono && numChannels == 1 && blockDelayWeights[0] == -1.0f)
+        return ChannelKernel::mono;
+
+    if (layoutKernel == ChannelKernel::stereo && numChannels == 2 && blockDelayWeights[0] == -1.0f && blockDelayWeights[1] == 1.0f)
+        return ChannelKernel::stereo;
+
+    return ChannelKernel::any;
+}
+
+template <typename SampleType>
+XyPadAudioProcessor::SubBlockKernel<SampleType> XyPadAudioProcessor::selectKernel(ChannelKernel channelKernel) const noexcept
+{
+    using Side = DelaySide;
+    using X = XyPadAudioProcessor;
+
+    // Indexed by [channel kernel][delayed side][smoothing]. While anything is
+    // smoothing the side doesn't matter, and the general kernel works out the
+    // delays per channel itself. A mono channel is only delayed on the left.
+    static constexpr SubBlockKernel<SampleType> haasKernels[3][3][2] = {
+        { { &X::processSubBlock<SampleType, 1, Side::none, false>,  &X::processSubBlock<SampleType, 1, Side::none, true> },
+          { &X::processSubBlock<SampleType, 1, Side::left, false>,  &X::processSubBlock<SampleType, 1, Side::none, true> },
+          { &X::processSubBlock<SampleType, 1, Side::none, false>,  &X::processSubBlock<SampleType, 1, Side::none, true> } },
+        { { &X::processSubBlock<SampleType, 2, Side::none, false>,  &X::processSubBlock<SampleType, 2, Side::none, true> },
+          { &X::processSubBlock<SampleType, 2, Side::left, false>,  &X::processSubBlock<SampleType, 2, Side::none, true> },
+          { &X::processSubBlock<SampleType, 2, Side::right, false>, &X::processSubBlock<SampleType, 2, Side::none, true> } },
+        { { &X::processSubBlock<SampleType, 0, Side::none, false>,  &X::processSubBlock<SampleType, 0, Side::none, true> },
+          { &X::processSubBlock<SampleType, 0, Side::none, false>,  &X::processSubBlock<SampleType, 0, Side::none, true> },
+          { &X::processSubBlock<SampleType, 0, Side::none, false>,  &X::processSubBlock<SampleType, 0, Side::none, true> } }
+    };
+
+    static constexpr SubBlockKernel<SampleType> feedbackKernels[2] = {
+        &X::processFeedbackSubBlock<SampleType, false>,
+        &X::processFeedbackSubBlock<SampleType, true>
+    };
+
+    const auto smoothing = delayTimeSmoother.isSmoothing() || dryWetSmoother.isSmoothing();
+
+    if (currentDelayMode == longDelayMode)
+        return feedbackKernels[smoothing || feedbackSmoother.isSmoothing() ? 1 : 0];
+
+    const auto target = delayTimeSmoother.getTargetValue();
+    const auto side = target < 0.0f ? Side::left : target > 0.0f ? Side::right : Side::none;
+
+    return haasKernels[static_cast<int>(channelKernel)][static_cast<int>(side)][smoothing ? 1 : 0];
+}
+
+template <typename SampleType, int NumChannels, XyPadAudioProcessor::DelaySide Side, bool Smoothing>
+void XyPadAudioProcessor::processSubBlock(juce::AudioBuffer<SampleType>& block, ProcessingChain<SampleType>& chain)
+{
+    using FVO = juce::FloatVectorOperations;
+
+    const auto numSamples = block.getNumSamples();
+    const auto numChannels = NumChannels > 0 ? NumChannels : block.getNumChannels();
+
+    // Filters ramp their own coefficients across the block, so they only need the end value
+    hpfSmoother.skip(numSamples);
+    lpfSmoother.skip(numSamples);
+    chain.filters.setHPFParameters(hpfSmoother.getCurrentValue(), 0.707f);
+    chain.filters.setLPFParameters(lpfSmoother.getCurrentValue(), 0.707f);
+
+    {
+        DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::filter);
+        chain.filters.process(block);
+    }
+
+    {
+        DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::delay);
+        chain.delayLine.write(block, numSamples);
+    }
+
+    if constexpr (Smoothing || NumChannels == 0)
+    {
+        {
+            // Delay stage: fills wetBuffer, leaving the filtered dry signal in block
+            DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::delay);
+            readDelayedChannels(chain, numChannels, numSamples, Smoothing && delayTimeSmoother.process(numSamples));
+            chain.delayLine.advance(numSamples);
+        }
+
+        DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::mix);
+        mixWetIntoDry(block, chain.wetBuffer, numChannels, numSamples, Smoothing && dryWetSmoother.process(numSamples));
+    }
+    else
+    {
+        // Settled on the default weights, at most one channel is delayed. The
+        // others' wet signal is their dry one, so they pass straight through.
+        constexpr int delayedChannel = Side == DelaySide::left ? 0 : Side == DelaySide::right ? 1 : -1;
+        static_assert(delayedChannel < NumChannels, "a mono kernel can only delay the left side");
+
+        {
+            DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::delay);
+
+            for (int channel = 0; channel < NumChannels; ++channel)
+                if (channel != delayedChannel)
+                    chain.delayLine.skipUndelayed(channel, numSamples);
+        }
+
+        if constexpr (delayedChannel >= 0)
+        {
+            const auto delayTimeInSamples = getChannelSpecificDelayTime(delayedChannel, delayTimeSmoother.getTargetValue(), maximumDelayTimeMs, getSampleRate());
+            const auto mix = static_cast<SampleType>(dryWetSmoother.getTargetValue());
+            auto* dry = block.getWritePointer(delayedChannel);
+            auto* wet = chain.wetBuffer.getWritePointer(delayedChannel);
+
+            {
+                DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::delay);
+                chain.delayLine.read(delayedChannel, delayTimeInSamples, wet, numSamples);
+            }
+
+            DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::mix);
+            FVO::multiply(dry, SampleType(1) - mix, numSamples);
+            FVO::addWithMultiply(dry, wet, mix, numSamples);
+        }
+
+        chain.delayLine.advance(numSamples);
+    }
+}
+
+template <typename SampleType, bool Smoothing>
+void XyPadAudioProcessor::processFeedbackSubBlock(juce::AudioBuffer<SampleType>& block, ProcessingChain<SampleType>& chain)
+{
+    const auto numSamples = block.getNumSamples();
+    const auto numChannels = block.getNumChannels();
+
+    hpfSmoother.skip(numSamples);
+    lpfSmoother.skip(numSamples);
+    chain.filters.setHPFParameters(hpfSmoother.getCurrentValue(), 0.707f);
+    chain.filters.setLPFParameters(lpfSmoother.getCurrentValue(), 0.707f);
+
+    // Both are compile-time false in the settled kernel, which folds their branches away
+    const auto delayIsSmoothing = Smoothing && delayTimeSmoother.process(numSamples);
+    const auto* feedbackRamp = Smoothing && feedbackSmoother.process(numSamples) ? feedbackSmoother.getRamp() : nullptr;
+    const auto feedback = static_cast<SampleType>(feedbackSmoother.getTargetValue());
+    const auto constantDelay = getLongDelayTime(delayTimeSmoother.getTargetValue());
+
+    if (delayIsSmoothing)
+        getLongDelayTimes(delayTimeSmoother.getRamp(), delayTimes.get(), numSamples);
+
+    // Every channel repeats at the same time, so they all share one set of taps
+    std::array<int, maximumNumChannels> allChannels;
+    std::array<SampleType*, maximumNumChannels> destinations;
+    std::array<const SampleType*, maximumNumChannels> feedbackChannels;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        allChannels[static_cast<size_t>(channel)] = channel;
+        feedbackChannels[static_cast<size_t>(channel)] = chain.feedbackBuffer.getReadPointer(channel);
+    }
+
+    // Read, filter and write back one slice at a time while it is still in
+    // cache. A slice only reads samples written by earlier slices, so it can
+    // be no longer than the shortest delay in it (less the one newer tap
+    // Lagrange and Thiran may use); at the minimum long delay that is still
+    // a whole sub-block at any rate from 44.1 kHz up.
+    for (int start = 0; start < numSamples;)
+    {
+        const auto shortestDelay = delayIsSmoothing ? juce::FloatVectorOperations::findMinimum(delayTimes.get() + start, numSamples - start)
+                                                    : constantDelay;
+        const auto length = juce::jlimit(1, numSamples - start, static_cast<int>(shortestDelay) - 1);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            destinations[static_cast<size_t>(channel)] = chain.wetBuffer.getWritePointer(channel, start);
+
+        {
+            DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::delay);
+
+            if (delayIsSmoothing)
+                chain.delayLine.read(allChannels.data(), numChannels, delayTimes.get() + start, destinations.data(), length);
+            else
+                for (int channel = 0; channel < numChannels; ++channel)
+                    chain.delayLine.read(channel, constantDelay, destinations[static_cast<size_t>(channel)], length);
+        }
+
+        {
+            // The filters sit inside the loop, so every repeat is darker and thinner than the last
+            DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::filter);
+            juce::AudioBuffer<SampleType> wetSlice(destinations.data(), numChannels, length);
+            chain.filters.process(wetSlice);
+        }
+
+        // The write-back counts as part of the delay stage
+        DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::delay);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* input = block.getReadPointer(channel, start);
+            const auto* wet = destinations[static_cast<size_t>(channel)];
+            auto* loop = chain.feedbackBuffer.getWritePointer(channel);
+
+            if (feedbackRamp != nullptr)
+                for (int i = 0; i < length; ++i)
+                    loop[i] = input[i] + wet[i] * feedbackRamp[start + i];
+            else
+                for (int i = 0; i < length; ++i)
+                    loop[i] = input[i] + wet[i] * feedback;
+        }
+
+        chain.delayLine.write(feedbackChannels.data(), numChannels, length);
+        chain.delayLine.advance(length);
+        start += length;
+    }
+
+    // The dry signal stays unfiltered in this mode
+    DspLoadMeter::ScopedStage stage(loadMeter, DspLoadMeter::Stage::mix);
+    mixWetIntoDry(block, chain.wetBuffer, numChannels, numSamples, Smoothing && dryWetSmoother.process(numSamples));
+}
+
+void XyPadAudioProcessor::updateHostTempo()
+{
+    // Keeps the last tempo the host reported when it stops reporting one
+    if (auto* playHead = getPlayHead())
+        if (const auto position = playHead->getPosition())
+            if (const auto bpm = position->getBpm())
+                if (*bpm > 0.0)
+                    hostBpm = *bpm;
+}
+
+float XyPadAudioProcessor::getDelayTimeTarget(const ParameterSnapshot& snapshot)
+{
+    if (! snapshot.tempoSync || snapshot.delayMode != longDelayMode)
+        return snapshot.delayTime;
+
+    // Note divisions in quarter notes, shortest first: the pad's distance from
+    // the centre picks one, and it is turned back into the pad value that
+    // getLongDelayTime maps to the same time, so smoothing and the kernel
+    // work unchanged. A tempo ramp moves the target a little every block and
+    // the delay smoother glides along behind it.
+    static constexpr double noteDivisions[] = {
+        1.0 / 24.0,  // 1/64T
+        1.0 / 16.0,  // 1/64
+        1.0 / 12.0,  // 1/32T
+        3.0 / 32.0,  // 1/64D
+        1.0 / 8.0,   // 1/32
+        1.0 / 6.0,   // 1/16T
+        3.0 / 16.0,  // 1/32D
+        1.0 / 4.0,   // 1/16
+        1.0 / 3.0,   // 1/8T
+        3.0 / 8.0,   // 1/16D
+        1.0 / 2.0,   // 1/8
+        2.0 / 3.0,   // 1/4T
+        3.0 / 4.0,   // 1/8D
+        1.0,         // 1/4
+        3.0 / 2.0    // 1/4D
+    };
+
+    constexpr auto numDivisions = static_cast<int>(std::size(noteDivisions));
+    const auto division = juce::jlimit(0, numDivisions - 1, juce::roundToInt(std::abs(snapshot.delayTime) / 17.5f * static_cast<float>(numDivisions - 1)));
+
+    // Only recomputed when the tempo or the division actually changes
+    if (division != syncedDivision || hostBpm != syncedBpm)
+    {
+        syncedDivision = division;
+        syncedBpm = hostBpm;
+
+        const auto delayTimeMs = noteDivisions[division] * 60000.0 / hostBpm;
+        syncedDelayTime = juce::jlimit(0.0f, 17.5f, static_cast<float>(delayTimeMs / maximumLongDelayMs * 17.5));
+    }
+
+    return syncedDelayTime;
+}
+
+float XyPadAudioProcessor::getLongDelayTime(float delayTimeValue) const
+{
+    // In long mode the pad's distance from the centre sets the repeat time
+    const auto delayTimeMs = juce::jmax(minimumLongDelayMs, std::abs(delayTimeValue) / 17.5f * maximumLongDelayMs);
+    return static_cast<float>(delayTimeMs * getSampleRate() / 1000.0);
+}
+
+void XyPadAudioProcessor::getLongDelayTimes(const float* delayTimeValues, float* destination, int numSamples) const
+{
+    using FVO = juce::FloatVectorOperations;
+
+    const auto samplesPerMs = static_cast<float>(getSampleRate() / 1000.0);
+
+    FVO::abs(destination, delayTimeValues, numSamples);
+    FVO::multiply(destination, maximumLongDelayMs / 17.5f * samplesPerMs, numSamples);
+    FVO::max(destination, destination, minimumLongDelayMs * samplesPerMs, numSamples);
+}
+
+template <typename SampleType>
+void XyPadAudioProcessor::readDelayedChannels(ProcessingChain<SampleType>& chain, int numChannels, int numSamples, bool delayIsSmoothing)
+{
+    // Per-sample delay only while the XY pad is moving; otherwise the taps are contiguous spans
+    if (! delayIsSmoothing)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
         {
-            DBG("No delay applied to Channel: " << channel);
+            const auto delayTimeInSamples = getChannelSpecificDelayTime(channel, delayTimeSmoother.getTargetValue(), maximumDelayTimeMs, getSampleRate());
+            RT_LOG_DEBUG(rtLog, "channel, delay (samples)", channel, delayTimeInSamples);
+            chain.delayLine.read(channel, delayTimeInSamples, chain.wetBuffer.getWritePointer(channel), numSamples);
         }
 
-        delayWritePosition = (delayWritePosition + buffer.getNumSamples()) % delayBufferLength;
+        return;
+    }
+
+    // Speakers with the same weight follow the same delay curve (every left
+    // speaker of a 7.1.4 bed, say), so each distinct weight maps the ramp and
+    // computes its taps once for its whole group of channels
+    std::array<bool, maximumNumChannels> done {};
+    std::array<int, maximumNumChannels> group;
+    std::array<SampleType*, maximumNumChannels> destinations;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        if (done[static_cast<size_t>(channel)])
+            continue;
+
+        const auto weight = blockDelayWeights[static_cast<size_t>(channel)];
+        int groupSize = 0;
+
+        for (int other = channel; other < numChannels; ++other)
+        {
+            if (! done[static_cast<size_t>(other)] && blockDelayWeights[static_cast<size_t>(other)] == weight)
+            {
+                done[static_cast<size_t>(other)] = true;
+                group[static_cast<size_t>(groupSize)] = other;
+                destinations[static_cast<size_t>(groupSize)] = chain.wetBuffer.getWritePointer(other);
+                ++groupSize;
+            }
+        }
+
+        if (weight == 0.0f)
+        {
+            // Never delayed, whatever the pad does
+            for (int i = 0; i < groupSize; ++i)
+                chain.delayLine.read(group[static_cast<size_t>(i)], 0.0f, destinations[static_cast<size_t>(i)], numSamples);
+
+            continue;
+        }
+
+        getChannelSpecificDelayTimes(channel, delayTimeSmoother.getRamp(), delayTimes.get(), numSamples);
+        chain.delayLine.read(group.data(), groupSize, delayTimes.get(), destinations.data(), numSamples);
     }
 }
 
+void XyPadAudioProcessor::getChannelSpecificDelayTimes(int channel, const float* delayTimeValues, float* destination, int numSamples) const
+{
+    using FVO = juce::FloatVectorOperations;
+
+    // Vectorised getChannelSpecificDelayTime over a ramp of pad values: left
+    // speakers take the negative half of the range, right speakers the
+    // positive half, each scaled by its weight
+    const auto side = blockDelayWeights[static_cast<size_t>(channel)];
 
-int XyPadAudioProcessor::getChannelSpecificDelayTime(int channel, float delayTimeValue, float maxDelayTimeMs, double sampleRate)
+    if (side == 0.0f)
+    {
+        FVO::clear(destination, numSamples);
+        return;
+    }
+
+    const auto samplesPerUnit = static_cast<float>(maximumDelayTimeMs / 17.5f * getSampleRate() / 1000.0);
+    FVO::copyWithMultiply(destination, delayTimeValues, side * samplesPerUnit, numSamples);
+    FVO::max(destination, destination, 0.0f, numSamples);
+}
+
+XyPadAudioProcessor::ParameterSnapshot XyPadAudioProcessor::readParameters() const noexcept
 {
+    return { delayTimeParameter->load(std::memory_order_relaxed),
+             dryWetMixParameter->load(std::memory_order_relaxed),
+             hpfFrequencyParameter->load(std::memory_order_relaxed),
+             lpfFrequencyParameter->load(std::memory_order_relaxed),
+             static_cast<int>(delayInterpolationParameter->load(std::memory_order_relaxed)),
+             static_cast<int>(delayModeParameter->load(std::memory_order_relaxed)),
+             feedbackParameter->load(std::memory_order_relaxed),
+             tempoSyncParameter->load(std::memory_order_relaxed) >= 0.5f,
+             bypassParameter->load(std::memory_order_relaxed) >= 0.5f };
+}
+
+template <typename SampleType>
+void XyPadAudioProcessor::mixWetIntoDry(juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>& wetBuffer,
+                                        int numChannels, int numSamples, bool mixIsSmoothing)
+{
+    using FVO = juce::FloatVectorOperations;
+
+    if (mixIsSmoothing)
+    {
+        // One float ramp shared by every channel, whatever the sample type:
+        // out = dry + (wet - dry) * mix[i], in a single pass
+        const auto* mixRamp = dryWetSmoother.getRamp();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* dry = buffer.getWritePointer(channel);
+            const auto* wet = wetBuffer.getReadPointer(channel);
+
+            for (int i = 0; i < numSamples; ++i)
+                dry[i] += (wet[i] - dry[i]) * static_cast<SampleType>(mixRamp[i]);
+        }
+
+        return;
+    }
+
+    const auto mix = static_cast<SampleType>(dryWetSmoother.getTargetValue());
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* dry = buffer.getWritePointer(channel);
+        const auto* wet = wetBuffer.getReadPointer(channel);
+
+        if (mix >= SampleType(1))
+        {
+            FVO::copy(dry, wet, numSamples);
+        }
+        else if (mix > SampleType(0))
+        {
+            FVO::multiply(dry, SampleType(1) - mix, numSamples);
+            FVO::addWithMultiply(dry, wet, mix, numSamples);
+        }
+    }
+}
+
+
+float XyPadAudioProcessor::getChannelSpecificDelayTime(int channel, float delayTimeValue, float maxDelayTimeMs, double sampleRate)
+{
+    // The channel's share of the pad value; left speakers have negative weights,
+    // so they end up positive (delayed) when the pad is on the left
+    const auto weightedValue = blockDelayWeights[static_cast<size_t>(channel)] * delayTimeValue;
+
     // Calculate a scaling factor based on half of the delayTimeValue range. (-17.5 a 17.5)
-    float scaleFactor = std::abs(delayTimeValue) / 17.5f;
+    float scaleFactor = std::abs(weightedValue) / 17.5f;
     float actualDelayTimeMs = scaleFactor * maxDelayTimeMs;
 
-    
-    int delayTimeInSamples = static_cast<int>(actualDelayTimeMs * sampleRate / 1000.0);
+    // Fractional: sub-sample delay differences are what Haas tuning is made of
+    float delayTimeInSamples = static_cast<float>(actualDelayTimeMs * sampleRate / 1000.0);
 
-    // If delayTimesValues is negative, apply delay on left channel
-    // add delay on right channel if delayTimeValues is positive
-    if ((channel == 0 && delayTimeValue < 0) || (channel == 1 && delayTimeValue > 0))
+    // If delayTimesValues is negative, apply delay on the left speakers
+    // add delay on the right speakers if delayTimeValues is positive
+    if (weightedValue > 0)
     {
-        DBG("Channell: " << (channel == 0 ? "Left" : "Right")
-            << ", Delay Value: " << delayTimeValue
-            << ", Delay Tempo (ms): " << actualDelayTimeMs
-            << ", Delay Time (Samples): " << delayTimeInSamples);
+        RT_LOG_DEBUG(rtLog, "delayed channel, pad value, delay (ms), delay (samples)",
+                     channel, delayTimeValue, actualDelayTimeMs, delayTimeInSamples);
 
         return delayTimeInSamples;
     }
 
-    DBG("No Delay: " << (channel == 0 ? "Sinistro" : "Destro"));
-    return 0; // Nessun delay per il canale se la condizione non è soddisfatta
+    return 0.0f; // Nessun delay per il canale se la condizione non è soddisfatta
 }
 
 
@@ -215,56 +1052,87 @@ void XyPadAudioProcessor::setStateInformation (const void* data, int sizeInBytes
     // whose contents will have been created by the getStateInformation() call.
 }
 
-AudioProcessorValueTreeState& XyPadAudioProcessor::getApvts()
+void XyPadAudioProcessor::numChannelsChanged()
 {
-    
-    return parameters;
-    
+    resetSpeakerDelayWeights();
+    allocateForMaximumConfiguration();
 }
 
-
-void XyPadAudioProcessor::parameterChanged(const String& parameterID, float newValue)
+float XyPadAudioProcessor::getDefaultSpeakerDelayWeight(juce::AudioChannelSet::ChannelType type)
 {
-    if (parameterID.equalsIgnoreCase("delayTime"))
-    {
-        // Smoothly update delayTime
-        float smoothValue = smoothParameterChange(prevDelayTime, newValue);
-        DBG("Parameter Changed: " << parameterID << " to " << smoothValue);
-        prevDelayTime = smoothValue;
+    using Set = juce::AudioChannelSet;
 
-        // Handle delayTime parameter change
-        // Update the delayTime parameter in your code as needed
-    }
-    else if (parameterID.equalsIgnoreCase("dryWetMix"))
-    {
-        // Smoothly update dryWetMix
-        float smoothValue = smoothParameterChange(prevDryWetValue, newValue);
-        // ...
-    }
-    else if (parameterID.equalsIgnoreCase("hpfFrequency"))
+    switch (type)
     {
-        // Smoothly update hpfFrequency
-        float smoothValue = smoothParameterChange(prevHPFFrequency, newValue);
-        DBG("HPF Frequency Parameter Changed: " << smoothValue);
-        prevHPFFrequency = smoothValue;
-
-        // Handle HPF frequency parameter change
-        // Update the HPF parameter in your Filters object
-        filters.setHPFParameters(smoothValue, 0.707f); // Example resonance value
+        case Set::left:
+        case Set::wideLeft:
+        case Set::leftSurround:
+        case Set::leftSurroundSide:
+        case Set::leftSurroundRear:
+        case Set::topFrontLeft:
+        case Set::topSideLeft:
+        case Set::topRearLeft:
+            return -1.0f;
+
+        case Set::right:
+        case Set::wideRight:
+        case Set::rightSurround:
+        case Set::rightSurroundSide:
+        case Set::rightSurroundRear:
+        case Set::topFrontRight:
+        case Set::topSideRight:
+        case Set::topRearRight:
+            return 1.0f;
+
+        case Set::leftCentre:
+            return -0.5f;
+
+        case Set::rightCentre:
+            return 0.5f;
+
+        default:
+            return 0.0f; // centre, LFE and anything on the median plane
     }
-    else if (parameterID.equalsIgnoreCase("lpfFrequency"))
+}
+
+void XyPadAudioProcessor::resetSpeakerDelayWeights()
+{
+    const auto layout = getChannelLayoutOfBus(false, 0);
+
+    for (int channel = 0; channel < maximumNumChannels; ++channel)
     {
-        // Smoothly update lpfFrequency
-        float smoothValue = smoothParameterChange(prevLPFFrequency, newValue);
-        DBG("LPF Frequency Parameter Changed: " << smoothValue);
-        prevLPFFrequency = smoothValue;
-
-        // Handle LPF frequency parameter change
-        // Update the LPF parameter in your Filters object
-        filters.setLPFParameters(smoothValue, 0.707f); // Example resonance value
+        auto weight = 0.0f;
+
+        // A mono bus is a single centre speaker; it keeps the original
+        // behaviour of being delayed like a left channel
+        if (layout == juce::AudioChannelSet::mono())
+            weight = channel == 0 ? -1.0f : 0.0f;
+        else if (channel < layout.size())
+            weight = getDefaultSpeakerDelayWeight(layout.getTypeOfChannel(channel));
+
+        speakerDelayWeights[static_cast<size_t>(channel)].store(weight);
     }
 }
 
+void XyPadAudioProcessor::setSpeakerDelayWeight(int channel, float weight)
+{
+    if (juce::isPositiveAndBelow(channel, maximumNumChannels))
+        speakerDelayWeights[static_cast<size_t>(channel)].store(juce::jlimit(-1.0f, 1.0f, weight));
+}
+
+float XyPadAudioProcessor::getSpeakerDelayWeight(int channel) const
+{
+    return juce::isPositiveAndBelow(channel, maximumNumChannels) ? speakerDelayWeights[static_cast<size_t>(channel)].load() : 0.0f;
+}
+
+AudioProcessorValueTreeState& XyPadAudioProcessor::getApvts()
+{
+    
+    return parameters;
+    
+}
+
+
 
 //==============================================================================
 // This creates new instances of the plugin..
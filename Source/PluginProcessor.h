@@ -10,11 +10,14 @@
 
 #include <JuceHeader.h>
 #include "Filters.h"
+#include "DelayLine.h"
+#include "ParameterSmoother.h"
+#include "RtLog.h"
+#include "DspLoadMeter.h"
 //==============================================================================
 /**
 */
-class XyPadAudioProcessor : public juce::AudioProcessor,
-    AudioProcessorValueTreeState::Listener
+class XyPadAudioProcessor : public juce::AudioProcessor
 {
 public:
     //==============================================================================
@@ -30,6 +33,12 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+    bool supportsDoublePrecisionProcessing() const override;
+    void numChannelsChanged() override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -55,40 +64,206 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
 
     AudioProcessorValueTreeState& getApvts();
-    
-    void updateFilters(float hpfFreq, float lpfFreq) {
-        // Assuming a fixed resonance value; adjust as needed.
-        float resonance = 0.707;
-        filters.setHPFParameters(hpfFreq, resonance);
-        filters.setLPFParameters(lpfFreq, resonance);
-    }
-
-    float XyPadAudioProcessor::smoothParameterChange(float oldValue, float newValue)
-    {
-        // Adjust the factor based on how quickly you want the parameter to change
-        const float smoothingFactor = 0.01f;
-        return oldValue + smoothingFactor * (newValue - oldValue);
-    }
 
-private:
-    float prevDelayTime = 0.0f;
-    float prevDryWetValue = 0.0f;
-    float prevHPFFrequency = 0.0f;
-    float prevLPFFrequency = 0.0f;
+    // Bytes held by the audio path. Fixed for a given channel layout:
+    // prepareToPlay and releaseResources never grow or free it.
+    size_t getMemoryFootprintBytes() const noexcept;
 
-    void parameterChanged(const String& parameterID, float newValue) override;
-	
+    // How much of the XY pad's delay each output channel takes, in [-1, 1].
+    // -1 takes the full delay when the pad is hard left, +1 when it is hard
+    // right, 0 is never delayed. Reset to follow the speaker positions
+    // whenever the channel layout changes.
+    void setSpeakerDelayWeight(int channel, float weight);
+    float getSpeakerDelayWeight(int channel) const;
+
+    // Per-block timings of this instance; read it from the message thread only
+    DspLoadMeter& getLoadMeter() noexcept { return loadMeter; }
+
+private:
     AudioProcessorValueTreeState parameters;
 
-    Filters filters;
+    // Everything processBlock needs from the parameters, read once per block.
+    // The APVTS atomics are looked up by ID once in the constructor, so taking
+    // a snapshot is a handful of relaxed loads: no hashing, no string compares,
+    // and the filters/delay are only ever touched from the audio thread.
+    struct ParameterSnapshot
+    {
+        float delayTime;
+        float dryWetMix;
+        float hpfFrequency;
+        float lpfFrequency;
+        int delayInterpolation;
+        int delayMode;
+        float feedback;
+        bool tempoSync;
+        bool bypass;
+    };
+
+    std::atomic<float>* delayTimeParameter = nullptr;
+    std::atomic<float>* dryWetMixParameter = nullptr;
+    std::atomic<float>* hpfFrequencyParameter = nullptr;
+    std::atomic<float>* lpfFrequencyParameter = nullptr;
+    std::atomic<float>* delayInterpolationParameter = nullptr;
+    std::atomic<float>* delayModeParameter = nullptr;
+    std::atomic<float>* feedbackParameter = nullptr;
+    std::atomic<float>* tempoSyncParameter = nullptr;
+    std::atomic<float>* bypassParameter = nullptr;
+
+    ParameterSnapshot readParameters() const noexcept;
+
+    static constexpr float maximumDelayTimeMs = 35.0f;
+
+    // Long mode: the pad sets a repeat time of up to two seconds, fed back
+    // through the filters
+    static constexpr int longDelayMode = 1;
+    static constexpr float minimumLongDelayMs = 10.0f;
+    static constexpr float maximumLongDelayMs = 2000.0f;
+    int currentDelayMode = 0;
+
+    // Tempo sync (Long mode only): the host tempo is read once per block and
+    // the synced target is cached until the tempo or the note division changes
+    double hostBpm = 120.0;
+    double syncedBpm = 0.0;
+    int syncedDivision = -1;
+    float syncedDelayTime = 0.0f;
+
+    void updateHostTempo();
+    float getDelayTimeTarget(const ParameterSnapshot& snapshot);
+
+    // Idle mode: once the input has been silent for longer than the tail and
+    // the output has followed it below the threshold, the delay line and
+    // filters have drained and processBlock passes the silence through
+    // untouched until sound comes back
+    static constexpr float silenceThreshold = 1.0e-6f; // -120 dBFS
+    juce::int64 silentSamples = 0;
+    bool outputWasSilent = false;
+    bool idle = false;
+    int idleSamplesToClear = 0;
+
+    // The host gets the time to fall by 60 dB, capped, so a bounce with high
+    // feedback doesn't append minutes of repeats; idle waits for -120 dB
+    static constexpr float hostTailThreshold = 1.0e-3f;
+    static constexpr double maximumHostTailSeconds = 60.0;
+
+    double getTailLengthSeconds(const ParameterSnapshot& snapshot) const;
+    double getTailLengthSeconds(int delayMode, float delayTimeValue, float feedback, float hpfFrequency, float lpfFrequency, float threshold) const;
+    double getCurrentTailLengthSeconds() const;
+    static double getFilterRingSeconds(float frequency, float threshold);
+    template <typename SampleType>
+    static bool isSilent(const juce::AudioBuffer<SampleType>& buffer, int numChannels);
+
+    // Bypass keeps the delay line written, so re-engaging never plays stale
+    // audio, and crossfades between the processed and the dry signal. In Haas
+    // mode it also keeps the input filters running, so the line holds what
+    // the chain would have written; only after a mode switch does the line
+    // need refilling, for as much of the Haas delay as it hasn't seen since.
+    static constexpr double bypassFadeSeconds = 0.01;
+    int bypassWarmUpRemaining = 0;
+    int filteredSamplesInLine = 0;
+    int getHaasDelayInSamples() const;
+
+    static constexpr double delaySmoothingSeconds = 0.05;
+    static constexpr double mixSmoothingSeconds = 0.02;
+    static constexpr double filterSmoothingSeconds = 0.03;
+
+    // Host blocks of any size are processed in slices of at most this many samples
+    static constexpr int subBlockSize = 256;
+
+    // The audio path is preallocated for this rate on the current layout
+    static constexpr double maximumSampleRate = 384000.0;
+    static constexpr int maximumNumChannels = 12; // 7.1.4
+
+    // Written on the message thread, copied into blockDelayWeights once per block
+    std::array<std::atomic<float>, maximumNumChannels> speakerDelayWeights;
+    std::array<float, maximumNumChannels> blockDelayWeights {};
+
+    static float getDefaultSpeakerDelayWeight(juce::AudioChannelSet::ChannelType type);
+    void resetSpeakerDelayWeights();
+
+    // Everything in the audio path that depends on the sample type. Only the
+    // chain for the precision the host picked holds any memory; the other is
+    // released, and there is no virtual dispatch between the two.
+    template <typename SampleType>
+    struct ProcessingChain
+    {
+        Filters<SampleType> filters;
+        DelayLine<SampleType> delayLine;
+        juce::AudioBuffer<SampleType> wetBuffer;
+        juce::AudioBuffer<SampleType> feedbackBuffer;
+        juce::AudioBuffer<SampleType> dryBuffer;
+
+        void allocate(int numChannels, int maxDelayInSamples, int maxBlockSize);
+        void release();
+        void prepare(int numChannels, int maxDelayInSamples, int maxBlockSize);
+        size_t getMemoryFootprintBytes() const noexcept;
+    };
+
+    // Sub-blocks are processed by kernels specialised at compile time on the
+    // channel count, which side is delayed and whether anything is smoothing,
+    // so their loops carry no per-channel or per-sample branches. The layout
+    // picks the channel kernel in prepareToPlay; each sub-block picks the rest.
+    enum class ChannelKernel { mono, stereo, any };
+    enum class DelaySide { none, left, right };
+
+    template <typename SampleType>
+    using SubBlockKernel = void (XyPadAudioProcessor::*)(juce::AudioBuffer<SampleType>&, ProcessingChain<SampleType>&);
+
+    ChannelKernel layoutKernel = ChannelKernel::any;
+
+    ChannelKernel getChannelKernel(int numChannels) const noexcept;
+    template <typename SampleType>
+    SubBlockKernel<SampleType> selectKernel(ChannelKernel channelKernel) const noexcept;
 
     // Variabili per il buffer di ritardo
-    juce::AudioBuffer<float> delayBuffer;
-    int delayBufferLength;
-    int delayWritePosition;
-    int delayReadPosition;
+    ProcessingChain<float> floatChain;
+    ProcessingChain<double> doubleChain;
+    bool chainIsDouble = false;
+
+    // Delay times are in float samples whatever the sample type
+    juce::HeapBlock<float> delayTimes;
+
+    // One smoother per automatable parameter. The delay is smoothed in pad
+    // units and mapped to per-channel samples afterwards, so crossing the
+    // centre glides one side down to zero before the other side rises.
+    ParameterSmoother delayTimeSmoother;
+    ParameterSmoother dryWetSmoother;
+    ParameterSmoother hpfSmoother;
+    ParameterSmoother lpfSmoother;
+    ParameterSmoother feedbackSmoother;
+    ParameterSmoother bypassSmoother;
+
+    DspLoadMeter loadMeter;
+
+   #if XYPAD_TRACE
+    // Keeps the process-wide trace buffers alive while any instance exists
+    juce::SharedResourcePointer<TraceSession> traceSession;
+   #endif
+
+   #if XYPAD_RT_LOG_LEVEL > 0
+    RtLog rtLog;
+   #endif
 
-    int getChannelSpecificDelayTime(int channel, float delayTimeValue, float maxDelayTimeMs, double sampleRate);
+    float getChannelSpecificDelayTime(int channel, float delayTimeValue, float maxDelayTimeMs, double sampleRate);
+    template <typename SampleType>
+    void readDelayedChannels(ProcessingChain<SampleType>& chain, int numChannels, int numSamples, bool delayIsSmoothing);
+    void getChannelSpecificDelayTimes(int channel, const float* delayTimeValues, float* destination, int numSamples) const;
+    void allocateForMaximumConfiguration();
+    template <typename SampleType>
+    void prepareChain(ProcessingChain<SampleType>& chain, int numChannels, int maxDelayInSamples, double sampleRate, const ParameterSnapshot& snapshot);
+    template <typename SampleType>
+    void processBlockWithChain(juce::AudioBuffer<SampleType>& buffer, ProcessingChain<SampleType>& chain, bool hostBypassed);
+    template <typename SampleType>
+    void processBypassedSubBlock(juce::AudioBuffer<SampleType>& block, ProcessingChain<SampleType>& chain);
+    void snapSmoothers();
+    template <typename SampleType, int NumChannels, DelaySide Side, bool Smoothing>
+    void processSubBlock(juce::AudioBuffer<SampleType>& block, ProcessingChain<SampleType>& chain);
+    template <typename SampleType, bool Smoothing>
+    void processFeedbackSubBlock(juce::AudioBuffer<SampleType>& block, ProcessingChain<SampleType>& chain);
+    float getLongDelayTime(float delayTimeValue) const;
+    void getLongDelayTimes(const float* delayTimeValues, float* destination, int numSamples) const;
+    template <typename SampleType>
+    void mixWetIntoDry(juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>& wetBuffer,
+                       int numChannels, int numSamples, bool mixIsSmoothing);
 
 	
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (XyPadAudioProcessor)
@@ -0,0 +1,85 @@
+#include "RtLog.h"
+
+RtLog::RtLog() {
+    writer->add(this);
+}
+
+RtLog::~RtLog() {
+    writer->remove(this);
+}
+
+void RtLog::pushRecord(const Record& record) noexcept {
+    const auto scope = fifo.write(1);
+
+    if (scope.blockSize1 > 0)
+        records[static_cast<size_t>(scope.startIndex1)] = record;
+    else if (scope.blockSize2 > 0)
+        records[static_cast<size_t>(scope.startIndex2)] = record;
+    else
+        dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RtLog::drain() {
+    const auto numReady = fifo.getNumReady();
+
+    if (numReady > 0) {
+        const auto scope = fifo.read(numReady);
+
+        for (int i = 0; i < scope.blockSize1; ++i)
+            Logger::writeToLog(format(records[static_cast<size_t>(scope.startIndex1 + i)]));
+
+        for (int i = 0; i < scope.blockSize2; ++i)
+            Logger::writeToLog(format(records[static_cast<size_t>(scope.startIndex2 + i)]));
+    }
+
+    if (const auto numDropped = dropped.exchange(0, std::memory_order_relaxed))
+        Logger::writeToLog("[rt] WARNING " + String(numDropped) + " log records dropped, FIFO full");
+}
+
+String RtLog::format(const Record& record) {
+    static const char* const levelNames[] = { "", "ERROR", "WARNING", "INFO", "DEBUG" };
+
+    auto text = "[rt " + String(Time::highResolutionTicksToSeconds(record.ticks) * 1000.0, 3) + " ms] "
+              + levelNames[static_cast<int>(record.level)] + " " + record.message;
+
+    for (int i = 0; i < record.numArguments; ++i)
+        text += (i == 0 ? ": " : ", ") + String(record.arguments[i]);
+
+    return text;
+}
+
+//==============================================================================
+RtLogWriter::RtLogWriter() : Thread("XyPad RT log writer") {
+    startThread();
+}
+
+RtLogWriter::~RtLogWriter() {
+    stopThread(1000);
+    drainAll();
+}
+
+void RtLogWriter::add(RtLog* log) {
+    const ScopedLock sl(lock);
+    logs.addIfNotAlreadyThere(log);
+}
+
+void RtLogWriter::remove(RtLog* log) {
+    const ScopedLock sl(lock);
+    log->drain();
+    logs.removeFirstMatchingValue(log);
+}
+
+void RtLogWriter::run() {
+    while (! threadShouldExit()) {
+        wait(50);
+        drainAll();
+    }
+}
+
+void RtLogWriter::drainAll() {
+    // Only the writer and add/remove take this lock, never the audio thread
+    const ScopedLock sl(lock);
+
+    for (auto* log : logs)
+        log->drain();
+}
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    RtLog.h
+    Real-time safe logging. The audio thread pushes fixed-size binary
+    records (a string literal plus up to four numbers) into a lock-free
+    FIFO; a shared background thread formats them and writes them to the
+    current juce::Logger.
+
+    Calls go through the RT_LOG_* macros, which compile to nothing above
+    XYPAD_RT_LOG_LEVEL (0 = off, 1 = error ... 4 = debug). Debug builds
+    default to 3, which logs mode, bypass and idle transitions; the
+    per-block parameter and delay dumps need 4. Release builds default to
+    0, so neither the calls nor the logger itself exist there.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef XYPAD_RT_LOG_LEVEL
+ #if JUCE_DEBUG
+  #define XYPAD_RT_LOG_LEVEL 3
+ #else
+  #define XYPAD_RT_LOG_LEVEL 0
+ #endif
+#endif
+
+class RtLogWriter;
+
+class RtLog {
+public:
+    enum class Level : uint8 { error = 1, warning, info, debug };
+
+    static constexpr int maxArguments = 4;
+
+    struct Record {
+        int64 ticks;
+        const char* message; // must be a string literal: only the pointer is stored
+        float arguments[maxArguments];
+        uint8 numArguments;
+        Level level;
+    };
+
+    RtLog();
+    ~RtLog();
+
+    // Wait-free, never allocates. Records are dropped (and counted) when the FIFO is full.
+    template <typename... Args>
+    void push(Level level, const char* message, Args... args) noexcept {
+        static_assert(sizeof...(Args) <= maxArguments, "RtLog records hold at most four arguments");
+        pushRecord({ Time::getHighResolutionTicks(), message, { static_cast<float>(args)... },
+                     static_cast<uint8>(sizeof...(Args)), level });
+    }
+
+    // Called by the writer thread: formats and writes everything pending.
+    void drain();
+
+private:
+    static constexpr int capacity = 1024;
+
+    AbstractFifo fifo { capacity };
+    std::array<Record, capacity> records {};
+    std::atomic<int> dropped { 0 };
+    SharedResourcePointer<RtLogWriter> writer;
+
+    void pushRecord(const Record& record) noexcept;
+    static String format(const Record& record);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RtLog)
+};
+
+// One background thread per process, shared by every RtLog.
+class RtLogWriter : private Thread {
+public:
+    RtLogWriter();
+    ~RtLogWriter() override;
+
+    void add(RtLog* log);
+    void remove(RtLog* log);
+
+private:
+    CriticalSection lock;
+    Array<RtLog*> logs;
+
+    void run() override;
+    void drainAll();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RtLogWriter)
+};
+
+#if XYPAD_RT_LOG_LEVEL >= 1
+ #define RT_LOG_ERROR(log, ...) (log).push(RtLog::Level::error, __VA_ARGS__)
+#else
+ #define RT_LOG_ERROR(log, ...) ((void) 0)
+#endif
+
+#if XYPAD_RT_LOG_LEVEL >= 2
+ #define RT_LOG_WARNING(log, ...) (log).push(RtLog::Level::warning, __VA_ARGS__)
+#else
+ #define RT_LOG_WARNING(log, ...) ((void) 0)
+#endif
+
+#if XYPAD_RT_LOG_LEVEL >= 3
+ #define RT_LOG_INFO(log, ...) (log).push(RtLog::Level::info, __VA_ARGS__)
+#else
+ #define RT_LOG_INFO(log, ...) ((void) 0)
+#endif
+
+#if XYPAD_RT_LOG_LEVEL >= 4
+ #define RT_LOG_DEBUG(log, ...) (log).push(RtLog::Level::debug, __VA_ARGS__)
+#else
+ #define RT_LOG_DEBUG(log, ...) ((void) 0)
+#endif
@@ -0,0 +1,127 @@
+#include "Trace.h"
+
+static std::atomic<TraceSession*> currentSession { nullptr };
+
+TraceSession::TraceSession() {
+    for (auto& thread : threads)
+        thread.slots = std::make_unique<Slot[]>(static_cast<size_t>(eventsPerThread));
+
+    currentSession.store(this, std::memory_order_release);
+}
+
+TraceSession::~TraceSession() {
+    currentSession.store(nullptr, std::memory_order_release);
+}
+
+TraceSession::ThreadBuffer* TraceSession::getBufferForCurrentThread() noexcept {
+    const auto threadId = Thread::getCurrentThreadId();
+
+    for (auto& thread : threads)
+        if (thread.owner.load(std::memory_order_acquire) == threadId)
+            return &thread;
+
+    // First span from this thread: claim a free buffer. Only this thread can
+    // claim on its own behalf, so losing a race just means trying the next one.
+    for (auto& thread : threads) {
+        Thread::ThreadID expected = nullptr;
+
+        if (thread.owner.compare_exchange_strong(expected, threadId, std::memory_order_acq_rel)) {
+            thread.isMessageThread.store(MessageManager::existsAndIsCurrentThread(), std::memory_order_release);
+            return &thread;
+        }
+    }
+
+    return nullptr;
+}
+
+void TraceSession::record(const char* name, int64 startTicks, int64 endTicks) noexcept {
+    auto* thread = getBufferForCurrentThread();
+
+    if (thread == nullptr)
+        return;
+
+    const auto index = thread->numWritten.load(std::memory_order_relaxed);
+    auto& slot = thread->slots[static_cast<size_t>(index & (eventsPerThread - 1))];
+
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startTicks.store(startTicks, std::memory_order_relaxed);
+    slot.endTicks.store(endTicks, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+
+    thread->numWritten.store(index + 1, std::memory_order_release);
+}
+
+Result TraceSession::writeChromeTrace(const File& file) const {
+    FileOutputStream stream(file);
+
+    if (! stream.openedOk())
+        return Result::fail("Could not open " + file.getFullPathName());
+
+    stream.setPosition(0);
+    stream.truncate();
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    const auto toMicroseconds = [](int64 ticks) {
+        return String(Time::highResolutionTicksToSeconds(ticks) * 1.0e6, 3);
+    };
+
+    auto first = true;
+    const auto separator = [&first] {
+        const auto* text = first ? "\n" : ",\n";
+        first = false;
+        return text;
+    };
+
+    for (int tid = 0; tid < maxThreads; ++tid) {
+        const auto& thread = threads[static_cast<size_t>(tid)];
+
+        if (thread.owner.load(std::memory_order_acquire) == nullptr)
+            continue;
+
+        const auto threadName = thread.isMessageThread.load(std::memory_order_acquire) ? String("message thread") : "thread " + String(tid);
+        stream << separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+               << ",\"args\":{\"name\":\"" << threadName << "\"}}";
+
+        // Copy what is there. A slot the writer lapped or is rewriting shows
+        // a different sequence and is dropped, so no event is ever torn.
+        const auto lastIndex = thread.numWritten.load(std::memory_order_acquire);
+        const auto firstIndex = lastIndex > eventsPerThread ? lastIndex - eventsPerThread : uint64 { 0 };
+
+        std::vector<Event> events;
+        events.reserve(static_cast<size_t>(lastIndex - firstIndex));
+
+        for (auto index = firstIndex; index != lastIndex; ++index) {
+            const auto& slot = thread.slots[static_cast<size_t>(index & (eventsPerThread - 1))];
+
+            if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+                continue;
+
+            const Event event { slot.name.load(std::memory_order_relaxed),
+                                slot.startTicks.load(std::memory_order_relaxed),
+                                slot.endTicks.load(std::memory_order_relaxed) };
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) == index + 1)
+                events.push_back(event);
+        }
+
+        for (const auto& event : events) {
+            stream << separator() << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                   << ",\"ts\":" << toMicroseconds(event.startTicks)
+                   << ",\"dur\":" << toMicroseconds(event.endTicks - event.startTicks) << "}";
+        }
+    }
+
+    stream << "\n]}\n";
+    stream.flush();
+
+    return stream.getStatus();
+}
+
+void Trace::record(const char* name, int64 startTicks, int64 endTicks) noexcept {
+    if (auto* session = currentSession.load(std::memory_order_acquire))
+        session->record(name, startTicks, endTicks);
+}
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    Trace.h
+    Opt-in span tracing for correlating audio dropouts with UI activity.
+    Every thread that records gets its own lock-free ring of timestamped
+    spans (the most recent ones win), and the whole lot can be written out
+    on demand as Chrome trace JSON, which chrome://tracing and Perfetto open.
+
+    Compiled in only when XYPAD_TRACE is 1; otherwise the XYPAD_TRACE_SCOPE
+    macro and the session members compile to nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef XYPAD_TRACE
+ #define XYPAD_TRACE 0
+#endif
+
+// Owns the per-thread buffers. Shared by every plugin instance in the
+// process through a SharedResourcePointer, so it is created and destroyed
+// on the message thread, never by the first span a thread records.
+class TraceSession {
+public:
+    TraceSession();
+    ~TraceSession();
+
+    // Wait-free and never allocates. Spans from more threads than there are
+    // buffers are dropped.
+    void record(const char* name, int64 startTicks, int64 endTicks) noexcept;
+
+    // Writes every span still held as a Chrome trace; safe while recording.
+    Result writeChromeTrace(const File& file) const;
+
+private:
+    static constexpr int maxThreads = 16;
+    static constexpr uint64 eventsPerThread = 1 << 15;
+
+    struct Event {
+        const char* name; // must be a string literal: only the pointer is stored
+        int64 startTicks;
+        int64 endTicks;
+    };
+
+    // A slot is rewritten while writeChromeTrace may be copying it, so every
+    // field is atomic and the sequence says which event it holds: the event's
+    // index plus one, or 0 while a write is under way. A copy only counts if
+    // the sequence is the expected one before and after reading the fields.
+    struct Slot {
+        std::atomic<uint64> sequence { 0 };
+        std::atomic<const char*> name { nullptr };
+        std::atomic<int64> startTicks { 0 };
+        std::atomic<int64> endTicks { 0 };
+    };
+
+    struct ThreadBuffer {
+        std::atomic<Thread::ThreadID> owner { nullptr };
+        std::atomic<uint64> numWritten { 0 };
+        std::atomic<bool> isMessageThread { false };
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    std::array<ThreadBuffer, maxThreads> threads;
+
+    ThreadBuffer* getBufferForCurrentThread() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TraceSession)
+};
+
+namespace Trace {
+    // Records into whichever session is alive; does nothing without one.
+    void record(const char* name, int64 startTicks, int64 endTicks) noexcept;
+
+    class Scope {
+    public:
+        explicit Scope(const char* nameToRecord) noexcept
+            : name(nameToRecord), start(Time::getHighResolutionTicks()) {}
+
+        ~Scope() { record(name, start, Time::getHighResolutionTicks()); }
+
+    private:
+        const char* name;
+        int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+}
+
+#if XYPAD_TRACE
+ #define XYPAD_TRACE_SCOPE(name) const Trace::Scope JUCE_JOIN_MACRO(traceScope, __LINE__)(name)
+#else
+ #define XYPAD_TRACE_SCOPE(name) ((void) 0)
+#endif
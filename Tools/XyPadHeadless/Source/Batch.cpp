@@ -0,0 +1,256 @@
+#include "Batch.h"
+#include "HeadlessHost.h"
+
+#include <iostream>
+#include <numeric>
+
+namespace Batch
+{
+    // Long mode repeats at most every 2 s, so once the output has been below
+    // -120 dBFS for that long nothing audible is left in the line.
+    static constexpr double tailSilenceSeconds = 2.0;
+    static constexpr float silenceThreshold = 1.0e-6f;
+
+    static AudioChannelSet getLayoutForChannels(int numChannels)
+    {
+        if (numChannels == 1) return AudioChannelSet::mono();
+        if (numChannels == 2) return AudioChannelSet::stereo();
+        return AudioChannelSet::canonicalChannelSet(numChannels);
+    }
+
+    static File getOutputFile(const Options& options, const File& input)
+    {
+        return options.outputDirectory.getChildFile(input.getFileName());
+    }
+
+    // Outputs are named after their inputs, so two inputs with the same name
+    // from different folders would have two threads writing one file.
+    // Sorted rather than compared pairwise: folders can hold thousands.
+    static bool reportDuplicateOutputs(const Options& options)
+    {
+        std::vector<int> order(static_cast<size_t>(options.inputFiles.size()));
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&options](int a, int b)
+        {
+            return getOutputFile(options, options.inputFiles[a]) < getOutputFile(options, options.inputFiles[b]);
+        });
+
+        auto found = false;
+
+        for (size_t i = 1; i < order.size(); ++i)
+        {
+            const auto& previous = options.inputFiles.getReference(order[i - 1]);
+            const auto& input = options.inputFiles.getReference(order[i]);
+
+            if (getOutputFile(options, previous) == getOutputFile(options, input))
+            {
+                std::cout << previous.getFullPathName() << " and " << input.getFullPathName() << " would both be written to "
+                          << getOutputFile(options, input).getFullPathName() << std::endl;
+                found = true;
+            }
+        }
+
+        return found;
+    }
+
+    class FileJob : public ThreadPoolJob
+    {
+    public:
+        FileJob(const Options& optionsToUse, const File& input, CriticalSection& outputLockToUse, std::atomic<int>& failuresToCount)
+            : ThreadPoolJob(input.getFileName()), options(optionsToUse), inputFile(input),
+              outputLock(outputLockToUse), failures(failuresToCount)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            const auto startTime = Time::getMillisecondCounterHiRes();
+            const auto result = process();
+            const auto seconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+            if (result.failed())
+                ++failures;
+
+            const ScopedLock lock(outputLock);
+
+            if (result.wasOk())
+                std::cout << inputFile.getFileName() << ": " << String(renderedSeconds, 1) << " s of audio in "
+                          << String(seconds, 2) << " s (" << String(renderedSeconds / jmax(seconds, 1.0e-3), 1) << "x)" << std::endl;
+            else
+                std::cout << inputFile.getFileName() << ": FAILED, " << result.getErrorMessage() << std::endl;
+
+            return jobHasFinished;
+        }
+
+    private:
+        const Options& options;
+        const File inputFile;
+        CriticalSection& outputLock;
+        std::atomic<int>& failures;
+        double renderedSeconds = 0.0;
+
+        Result process()
+        {
+            const auto outputFile = getOutputFile(options, inputFile);
+
+            if (outputFile == inputFile)
+                return Result::fail("the output would overwrite the input");
+
+            if (outputFile.exists() && ! options.overwrite)
+                return Result::fail(outputFile.getFullPathName() + " already exists");
+
+            // Each job has its own format manager: it is cheap, and readers and
+            // writers then share nothing between threads.
+            AudioFormatManager formatManager;
+            formatManager.registerBasicFormats();
+
+            std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(inputFile));
+
+            if (reader == nullptr)
+                return Result::fail("not a readable audio file");
+
+            const auto numChannels = static_cast<int>(reader->numChannels);
+            const auto sampleRate = reader->sampleRate;
+
+            HeadlessHost host;
+
+            if (! host.setChannelLayout(getLayoutForChannels(numChannels)))
+                return Result::fail("the processor does not support " + String(numChannels) + " channels");
+
+            auto& apvts = host.getProcessor().getApvts();
+
+            if (options.preset.isValid())
+            {
+                if (! options.preset.hasType(apvts.state.getType()))
+                    return Result::fail("the preset is not an XyPad parameter state");
+
+                apvts.replaceState(options.preset.createCopy());
+            }
+
+            for (const auto& parameterID : options.parameterValues.getAllKeys())
+            {
+                if (apvts.getParameter(parameterID) == nullptr)
+                    return Result::fail("unknown parameter " + parameterID);
+
+                host.setParameter(parameterID, options.parameterValues[parameterID].getFloatValue());
+            }
+
+            host.prepare(sampleRate, options.chunkSize);
+
+            auto* format = formatManager.findFormatForFileExtension(outputFile.getFileExtension());
+
+            if (format == nullptr)
+                return Result::fail("no writer for " + outputFile.getFileExtension() + " files");
+
+            outputFile.deleteFile();
+            auto stream = outputFile.createOutputStream();
+
+            if (stream == nullptr)
+                return Result::fail("could not create " + outputFile.getFullPathName());
+
+            const auto bitsPerSample = static_cast<int>(reader->bitsPerSample);
+            std::unique_ptr<AudioFormatWriter> writer(format->createWriterFor(stream.get(), sampleRate, reader->numChannels,
+                                                                              bitsPerSample, reader->metadataValues, 0));
+
+            if (writer == nullptr)
+                return Result::fail("could not write " + String(bitsPerSample) + "-bit " + format->getFormatName());
+
+            stream.release(); // the writer owns it now
+
+            // The only buffer: the file streams through it one chunk at a time
+            AudioBuffer<float> buffer(numChannels, options.chunkSize);
+
+            for (int64 position = 0; position < reader->lengthInSamples; position += options.chunkSize)
+            {
+                if (shouldExit())
+                    return Result::fail("cancelled");
+
+                const auto numSamples = static_cast<int>(jmin(static_cast<int64>(options.chunkSize), reader->lengthInSamples - position));
+
+                if (! reader->read(&buffer, 0, numSamples, position, true, true))
+                    return Result::fail("read error at sample " + String(position));
+
+                // A short last chunk is processed as a short block, so the tail
+                // carries on exactly where the file ends
+                AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+                host.process(block);
+
+                if (! writer->writeFromAudioSampleBuffer(buffer, 0, numSamples))
+                    return Result::fail("write error at sample " + String(position));
+            }
+
+            auto numTailSamples = int64 { 0 };
+
+            if (options.renderTail)
+            {
+                const auto tailLength = static_cast<int64>(host.getProcessor().getTailLengthSeconds() * sampleRate);
+                const auto silenceToStop = static_cast<int64>(tailSilenceSeconds * sampleRate);
+                auto silentSamples = int64 { 0 };
+
+                while (numTailSamples < tailLength && silentSamples < silenceToStop)
+                {
+                    if (shouldExit())
+                        return Result::fail("cancelled");
+
+                    const auto numSamples = static_cast<int>(jmin(static_cast<int64>(options.chunkSize), tailLength - numTailSamples));
+                    AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+                    block.clear();
+                    host.process(block);
+
+                    silentSamples = buffer.getMagnitude(0, numSamples) < silenceThreshold ? silentSamples + numSamples : 0;
+
+                    if (! writer->writeFromAudioSampleBuffer(buffer, 0, numSamples))
+                        return Result::fail("write error in the tail");
+
+                    numTailSamples += numSamples;
+                }
+            }
+
+            if (! writer->flush())
+                return Result::fail("could not flush " + outputFile.getFullPathName());
+
+            renderedSeconds = static_cast<double>(reader->lengthInSamples + numTailSamples) / sampleRate;
+            return Result::ok();
+        }
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FileJob)
+    };
+
+    int run(const Options& options)
+    {
+        if (reportDuplicateOutputs(options))
+        {
+            std::cout << "Nothing processed: rename the inputs or process them into separate folders" << std::endl;
+            return options.inputFiles.size();
+        }
+
+        if (! options.outputDirectory.createDirectory())
+        {
+            std::cout << "Could not create " << options.outputDirectory.getFullPathName() << std::endl;
+            return options.inputFiles.size();
+        }
+
+        const auto numThreads = jlimit(1, jmax(1, options.inputFiles.size()), options.numThreads);
+        std::cout << "Processing " << options.inputFiles.size() << " file(s) on " << numThreads << " thread(s)" << std::endl;
+
+        CriticalSection outputLock;
+        std::atomic<int> failures { 0 };
+        const auto startTime = Time::getMillisecondCounterHiRes();
+
+        {
+            ThreadPool pool(numThreads);
+
+            for (const auto& file : options.inputFiles)
+                pool.addJob(new FileJob(options, file, outputLock, failures), true);
+
+            while (pool.getNumJobs() > 0)
+                Thread::sleep(50);
+        }
+
+        const auto seconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+        std::cout << std::endl << options.inputFiles.size() - failures.load() << " of " << options.inputFiles.size()
+                  << " file(s) processed in " << String(seconds, 2) << " s" << std::endl;
+
+        return failures.load();
+    }
+}
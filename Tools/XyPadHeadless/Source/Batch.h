@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+    Batch.h
+    Offline batch processing of audio files through XyPadAudioProcessor.
+    Files are spread over a thread pool, each job runs its own processor
+    instance and streams its file through it in fixed-size chunks, so
+    memory use does not grow with the length of the files.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Batch
+{
+    struct Options
+    {
+        Array<File> inputFiles;
+        File outputDirectory;
+        ValueTree preset;                 // APVTS state to start from; may be invalid
+        StringPairArray parameterValues;  // parameter ID -> value in the parameter's own range
+        int numThreads = SystemStats::getNumCpus();
+        int chunkSize = 4096;
+        bool renderTail = false;          // append the processor's tail after the input ends
+        bool overwrite = false;
+    };
+
+    // Returns the number of files that could not be processed.
+    int run(const Options& options);
+}
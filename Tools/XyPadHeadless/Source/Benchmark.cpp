@@ -0,0 +1,197 @@
+#include "Benchmark.h"
+#include "HeadlessHost.h"
+
+#include <iostream>
+
+namespace Benchmark
+{
+    std::vector<ParameterSet> getDefaultParameterSets()
+    {
+        return {
+            { "centre",    0.0f,   0.5f, 20.0f,  20000.0f, false },
+            { "left-haas", -17.5f, 1.0f, 440.0f, 5000.0f,  false },
+            { "right-mid", 8.75f,  0.5f, 200.0f, 12000.0f, false },
+            { "automated", 0.0f,   0.5f, 440.0f, 5000.0f,  true  },
+            { "long-fb",   8.75f,  0.5f, 200.0f, 8000.0f,  false, 1, 0.6f },
+            { "bypassed",  8.75f,  0.5f, 200.0f, 8000.0f,  false, 0, 0.0f, true }
+        };
+    }
+
+    static void fillNoise(AudioBuffer<float>& buffer, Random& random)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            auto* data = buffer.getWritePointer(channel);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                data[i] = (random.nextFloat() * 2.0f - 1.0f) * 0.25f;
+        }
+    }
+
+    static void applyParameters(HeadlessHost& host, const ParameterSet& parameters)
+    {
+        host.setParameter("delayTime", parameters.delayTime);
+        host.setParameter("dryWetMix", parameters.dryWetMix);
+        host.setParameter("hpfFrequency", parameters.hpfFrequency);
+        host.setParameter("lpfFrequency", parameters.lpfFrequency);
+        host.setParameter("delayMode", static_cast<float>(parameters.delayMode));
+        host.setParameter("feedback", parameters.feedback);
+        host.setParameter("bypass", parameters.bypass ? 1.0f : 0.0f);
+    }
+
+    static void automateParameters(HeadlessHost& host, int blockIndex)
+    {
+        // One slow LFO cycle every 256 blocks, so every block sees a new value.
+        const auto phase = MathConstants<float>::twoPi * static_cast<float>(blockIndex % 256) / 256.0f;
+        const auto lfo = std::sin(phase);
+
+        host.setParameter("delayTime", 17.5f * lfo);
+        host.setParameter("hpfFrequency", 200.0f + 150.0f * lfo);
+        host.setParameter("lpfFrequency", 6000.0f + 4000.0f * lfo);
+    }
+
+    Result runCase(const AudioChannelSet& layout, double sampleRate, int blockSize, const ParameterSet& parameters, double seconds)
+    {
+        HeadlessHost host;
+        const auto layoutAccepted = host.setChannelLayout(layout);
+        jassert(layoutAccepted);
+        ignoreUnused(layoutAccepted);
+
+        applyParameters(host, parameters);
+        host.prepare(sampleRate, blockSize);
+
+        const auto numChannels = host.getProcessor().getTotalNumInputChannels();
+
+        // One second of source material, copied into the work buffer outside the timed region.
+        Random random(0x5eed);
+        AudioBuffer<float> source(numChannels, static_cast<int>(sampleRate) + blockSize);
+        fillNoise(source, random);
+
+        AudioBuffer<float> buffer(numChannels, blockSize);
+
+        const auto numBlocks = jmax(1, static_cast<int>(seconds * sampleRate / blockSize));
+        const auto sourceBlocks = (source.getNumSamples() - blockSize) / blockSize;
+
+        // Warm up caches and let any parameter smoothing settle.
+        for (int block = 0; block < jmin(numBlocks, 64); ++block)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.copyFrom(channel, 0, source, channel, 0, blockSize);
+
+            host.process(buffer);
+        }
+
+        int64 totalTicks = 0;
+        int64 worstTicks = 0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const auto sourceOffset = (block % jmax(1, sourceBlocks)) * blockSize;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.copyFrom(channel, 0, source, channel, sourceOffset, blockSize);
+
+            if (parameters.automate)
+                automateParameters(host, block);
+
+            const auto start = Time::getHighResolutionTicks();
+            host.process(buffer);
+            const auto elapsed = Time::getHighResolutionTicks() - start;
+
+            totalTicks += elapsed;
+            worstTicks = jmax(worstTicks, elapsed);
+        }
+
+        const auto totalSeconds = Time::highResolutionTicksToSeconds(totalTicks);
+        const auto worstSeconds = Time::highResolutionTicksToSeconds(worstTicks);
+        const auto renderedSamples = static_cast<double>(numBlocks) * blockSize;
+        const auto blockDuration = blockSize / sampleRate;
+
+        Result result;
+        result.sampleRate = sampleRate;
+        result.blockSize = blockSize;
+        result.parameterSet = parameters.name;
+        result.nsPerSample = totalSeconds * 1.0e9 / renderedSamples;
+        result.realtimeFactor = totalSeconds > 0.0 ? (renderedSamples / sampleRate) / totalSeconds : 0.0;
+        result.worstBlockUs = worstSeconds * 1.0e6;
+        result.worstBlockLoad = worstSeconds / blockDuration;
+        return result;
+    }
+
+    static String formatResult(const Result& r, bool csv)
+    {
+        if (csv)
+            return String(r.sampleRate, 0) + "," + String(r.blockSize) + "," + r.parameterSet + ","
+                 + String(r.nsPerSample, 3) + "," + String(r.realtimeFactor, 1) + ","
+                 + String(r.worstBlockUs, 2) + "," + String(r.worstBlockLoad * 100.0, 3);
+
+        return String(r.sampleRate, 0).paddedLeft(' ', 8)
+             + String(r.blockSize).paddedLeft(' ', 7)
+             + "  " + r.parameterSet.paddedRight(' ', 10)
+             + String(r.nsPerSample, 3).paddedLeft(' ', 12)
+             + String(r.realtimeFactor, 1).paddedLeft(' ', 12)
+             + String(r.worstBlockUs, 2).paddedLeft(' ', 14)
+             + String(r.worstBlockLoad * 100.0, 3).paddedLeft(' ', 12);
+    }
+
+    // The audio path is sized for 384 kHz and the 2 s Long-mode delay whatever
+    // the rate, so the footprint only depends on the layout and the precision
+    static void printMemoryFootprints()
+    {
+        const std::pair<const char*, AudioChannelSet> layouts[] = {
+            { "mono",   AudioChannelSet::mono() },
+            { "stereo", AudioChannelSet::stereo() },
+            { "5.1",    AudioChannelSet::create5point1() },
+            { "7.1",    AudioChannelSet::create7point1() },
+            { "7.1.4",  AudioChannelSet::create7point1point4() }
+        };
+
+        std::cout << std::endl << "Audio-path memory footprint (MiB)" << std::endl
+                  << "  layout       float      double" << std::endl;
+
+        for (const auto& layout : layouts)
+        {
+            String line = String("  ") + String(layout.first).paddedRight(' ', 8);
+
+            for (auto precision : { AudioProcessor::singlePrecision, AudioProcessor::doublePrecision })
+            {
+                HeadlessHost host;
+                host.setChannelLayout(layout.second);
+                host.prepare(48000.0, 512, precision);
+                line += String(host.getProcessor().getMemoryFootprintBytes() / (1024.0 * 1024.0), 1).paddedLeft(' ', 12);
+            }
+
+            std::cout << line << std::endl;
+        }
+    }
+
+    int run(const Options& options)
+    {
+        const auto parameterSets = options.parameterSets.empty() ? getDefaultParameterSets()
+                                                                 : options.parameterSets;
+
+        if (options.csv)
+            std::cout << "sample_rate,block_size,parameters,ns_per_sample,realtime_factor,worst_block_us,worst_block_load_pct" << std::endl;
+        else
+            std::cout << "    rate  block  parameters   ns/sample    realtime x  worst blk (us)  worst load%" << std::endl;
+
+        double worstLoad = 0.0;
+
+        for (auto sampleRate : options.sampleRates)
+            for (auto blockSize : options.blockSizes)
+                for (const auto& parameters : parameterSets)
+                {
+                    const auto result = runCase(options.layout, sampleRate, blockSize, parameters, options.secondsPerCase);
+                    worstLoad = jmax(worstLoad, result.worstBlockLoad);
+                    std::cout << formatResult(result, options.csv) << std::endl;
+                }
+
+        if (! options.csv)
+        {
+            std::cout << std::endl << "Worst block load across all cases: " << String(worstLoad * 100.0, 3) << "%" << std::endl;
+            printMemoryFootprints();
+        }
+
+        return 0;
+    }
+}
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    Benchmark.h
+    Offline throughput benchmark for XyPadAudioProcessor::processBlock.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Benchmark
+{
+    struct ParameterSet
+    {
+        String name;
+        float delayTime;
+        float dryWetMix;
+        float hpfFrequency;
+        float lpfFrequency;
+        bool automate; // sweep delayTime and the filters once per block
+        int delayMode = 0;
+        float feedback = 0.0f;
+        bool bypass = false;
+    };
+
+    struct Options
+    {
+        Array<double> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+        Array<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+        std::vector<ParameterSet> parameterSets;
+        AudioChannelSet layout = AudioChannelSet::stereo();
+        double secondsPerCase = 5.0;
+        bool csv = false;
+    };
+
+    struct Result
+    {
+        double sampleRate;
+        int blockSize;
+        String parameterSet;
+        double nsPerSample;      // per frame (one sample on every channel)
+        double realtimeFactor;   // seconds of audio rendered per second of CPU
+        double worstBlockUs;
+        double worstBlockLoad;   // worst block time / block duration
+    };
+
+    std::vector<ParameterSet> getDefaultParameterSets();
+
+    Result runCase(const AudioChannelSet& layout, double sampleRate, int blockSize, const ParameterSet& parameters, double seconds);
+    int run(const Options& options);
+}
@@ -0,0 +1,93 @@
+#include "HeadlessHost.h"
+
+HeadlessHost::HeadlessHost() : processor(std::make_unique<XyPadAudioProcessor>())
+{
+}
+
+HeadlessHost::~HeadlessHost()
+{
+    release();
+}
+
+bool HeadlessHost::setChannelLayout(const AudioChannelSet& layout)
+{
+    release();
+
+    AudioProcessor::BusesLayout buses;
+    buses.inputBuses.add(layout);
+    buses.outputBuses.add(layout);
+
+    return processor->setBusesLayout(buses);
+}
+
+void HeadlessHost::prepare(double sampleRate, int maximumBlockSize, AudioProcessor::ProcessingPrecision precision)
+{
+    release();
+
+    jassert(precision == AudioProcessor::singlePrecision || processor->supportsDoublePrecisionProcessing());
+    processor->setProcessingPrecision(precision);
+
+    const auto numChannels = processor->getMainBusNumInputChannels();
+    processor->setPlayConfigDetails(numChannels, numChannels, sampleRate, maximumBlockSize);
+    processor->prepareToPlay(sampleRate, maximumBlockSize);
+
+    currentSampleRate = sampleRate;
+    currentBlockSize = maximumBlockSize;
+    prepared = true;
+}
+
+void HeadlessHost::release()
+{
+    if (prepared)
+        processor->releaseResources();
+
+    prepared = false;
+}
+
+void HeadlessHost::setParameter(const String& parameterID, float value)
+{
+    auto* parameter = processor->getApvts().getParameter(parameterID);
+    jassert(parameter != nullptr);
+
+    if (parameter != nullptr)
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+void HeadlessHost::setPlayHead(AudioPlayHead* playHead)
+{
+    processor->setPlayHead(playHead);
+}
+
+template <typename SampleType>
+void HeadlessHost::processBuffer(AudioBuffer<SampleType>& buffer, bool bypassed)
+{
+    jassert(prepared);
+    jassert(buffer.getNumSamples() <= currentBlockSize);
+
+    midi.clear();
+
+    if (bypassed)
+        processor->processBlockBypassed(buffer, midi);
+    else
+        processor->processBlock(buffer, midi);
+}
+
+void HeadlessHost::process(AudioBuffer<float>& buffer)
+{
+    processBuffer(buffer, false);
+}
+
+void HeadlessHost::process(AudioBuffer<double>& buffer)
+{
+    processBuffer(buffer, false);
+}
+
+void HeadlessHost::processBypassed(AudioBuffer<float>& buffer)
+{
+    processBuffer(buffer, true);
+}
+
+void HeadlessHost::processBypassed(AudioBuffer<double>& buffer)
+{
+    processBuffer(buffer, true);
+}
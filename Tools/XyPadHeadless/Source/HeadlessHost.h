@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    HeadlessHost.h
+    Minimal in-process host that drives XyPadAudioProcessor without a
+    plugin wrapper, an audio device or an editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+class HeadlessHost
+{
+public:
+    HeadlessHost();
+    ~HeadlessHost();
+
+    // Applies the same layout to the main input and output buses. Returns false
+    // if the processor rejects it. Call before prepare().
+    bool setChannelLayout(const AudioChannelSet& layout);
+
+    // Mirrors what a host does on activation: set the play config, then prepareToPlay.
+    void prepare(double sampleRate, int maximumBlockSize,
+                 AudioProcessor::ProcessingPrecision precision = AudioProcessor::singlePrecision);
+    void release();
+
+    // Sets a parameter in its real-world range (e.g. Hz for the filters).
+    void setParameter(const String& parameterID, float value);
+
+    void setPlayHead(AudioPlayHead* playHead);
+
+    void process(AudioBuffer<float>& buffer);
+    void process(AudioBuffer<double>& buffer);
+
+    // The host's own bypass, i.e. processBlockBypassed.
+    void processBypassed(AudioBuffer<float>& buffer);
+    void processBypassed(AudioBuffer<double>& buffer);
+
+    XyPadAudioProcessor& getProcessor() noexcept { return *processor; }
+    double getSampleRate() const noexcept { return currentSampleRate; }
+    int getMaximumBlockSize() const noexcept { return currentBlockSize; }
+
+private:
+    template <typename SampleType>
+    void processBuffer(AudioBuffer<SampleType>& buffer, bool bypassed);
+
+    std::unique_ptr<XyPadAudioProcessor> processor;
+    MidiBuffer midi;
+
+    double currentSampleRate = 0.0;
+    int currentBlockSize = 0;
+    bool prepared = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HeadlessHost)
+};
@@ -0,0 +1,249 @@
+#include "IrAtlas.h"
+#include "HeadlessHost.h"
+
+#include <iostream>
+
+namespace IrAtlas
+{
+    static constexpr int renderBlockSize = 512;
+
+    // Enough cells per job to amortise building a processor, few enough
+    // that the last jobs still spread over all threads.
+    static constexpr int cellsPerJob = 32;
+
+    static constexpr uint64 alignment = 64;
+
+    static uint64 alignUp(uint64 offset)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    // A single step sits on the parameter's default, so a one-row grid is the plugin as loaded.
+    static Array<float> spreadOverRange(AudioProcessorValueTreeState& apvts, const String& parameterID, int numSteps)
+    {
+        const auto& range = apvts.getParameterRange(parameterID);
+        const auto defaultValue = apvts.getParameter(parameterID)->getDefaultValue();
+        Array<float> values;
+
+        for (int i = 0; i < numSteps; ++i)
+        {
+            const auto proportion = numSteps == 1 ? defaultValue : static_cast<float>(i) / static_cast<float>(numSteps - 1);
+            values.add(range.snapToLegalValue(range.convertFrom0to1(proportion)));
+        }
+
+        return values;
+    }
+
+    static Array<float> snapToRange(AudioProcessorValueTreeState& apvts, const String& parameterID, const Array<float>& requested)
+    {
+        const auto& range = apvts.getParameterRange(parameterID);
+        Array<float> values;
+
+        for (auto value : requested)
+            values.add(range.snapToLegalValue(value));
+
+        return values;
+    }
+
+    //==============================================================================
+    class RenderJob : public ThreadPoolJob
+    {
+    public:
+        RenderJob(char* fileDataToUse, int firstCellToRender, int endCellToRender)
+            : ThreadPoolJob("IR cells " + String(firstCellToRender)), fileData(fileDataToUse),
+              firstCell(firstCellToRender), endCell(endCellToRender)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            const auto& header = *reinterpret_cast<const FileHeader*>(fileData);
+            auto* entries = reinterpret_cast<CellEntry*>(fileData + header.indexOffset);
+
+            const auto numChannels = static_cast<int>(header.numChannels);
+            const auto irLength = static_cast<int>(header.irLength);
+
+            HeadlessHost host;
+            host.setParameter("delayMode", 0.0f);
+            host.setParameter("delayInterpolation", static_cast<float>(header.delayInterpolation));
+            host.setParameter("tempoSync", 0.0f);
+            host.setParameter("bypass", 0.0f);
+
+            AudioBuffer<float> buffer(numChannels, irLength);
+
+            for (int cell = firstCell; cell < endCell; ++cell)
+            {
+                if (shouldExit())
+                    break;
+
+                auto& entry = entries[cell];
+
+                // Set before prepare, so every cell starts from a cleared line
+                // with settled smoothers, exactly as a fresh instance would
+                host.setParameter("delayTime", entry.delayTime);
+                host.setParameter("dryWetMix", entry.dryWetMix);
+                host.setParameter("hpfFrequency", entry.hpfFrequency);
+                host.setParameter("lpfFrequency", entry.lpfFrequency);
+                host.prepare(header.sampleRate, renderBlockSize);
+
+                buffer.clear();
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    buffer.setSample(channel, 0, 1.0f);
+
+                for (int start = 0; start < irLength; start += renderBlockSize)
+                {
+                    AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, start, jmin(renderBlockSize, irLength - start));
+                    host.process(block);
+                }
+
+                auto* destination = reinterpret_cast<float*>(fileData + entry.dataOffset);
+                auto energy = 0.0;
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    const auto* samples = buffer.getReadPointer(channel);
+                    FloatVectorOperations::copy(destination + channel * irLength, samples, irLength);
+
+                    for (int i = 0; i < irLength; ++i)
+                        energy += static_cast<double>(samples[i]) * samples[i];
+                }
+
+                entry.peak = buffer.getMagnitude(0, irLength);
+                entry.energy = static_cast<float>(energy);
+            }
+
+            return jobHasFinished;
+        }
+
+    private:
+        char* const fileData;
+        const int firstCell, endCell;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderJob)
+    };
+
+    //==============================================================================
+    int run(const Options& options)
+    {
+        HeadlessHost host;
+        auto& apvts = host.getProcessor().getApvts();
+
+        const auto delayTimes = spreadOverRange(apvts, "delayTime", options.numDelayTimes);
+        const auto mixes = spreadOverRange(apvts, "dryWetMix", options.numMixes);
+        const auto hpfFrequencies = snapToRange(apvts, "hpfFrequency", options.hpfFrequencies);
+        const auto lpfFrequencies = snapToRange(apvts, "lpfFrequency", options.lpfFrequencies);
+
+        const auto numCells = static_cast<int64>(delayTimes.size()) * mixes.size() * hpfFrequencies.size() * lpfFrequencies.size();
+
+        if (numCells <= 0 || numCells > std::numeric_limits<int>::max())
+        {
+            std::cout << "The grid has " << String(numCells) << " cells" << std::endl;
+            return 1;
+        }
+
+        // Every cell gets the tail of the slowest one: the longest pad delay in
+        // Haas mode, and the lowest cutoffs, which ring out the longest
+        auto longestDelayTime = 0.0f;
+
+        for (auto delayTime : delayTimes)
+            longestDelayTime = jmax(longestDelayTime, std::abs(delayTime));
+
+        host.setParameter("delayMode", 0.0f);
+        host.setParameter("delayTime", longestDelayTime);
+        host.setParameter("hpfFrequency", *std::min_element(hpfFrequencies.begin(), hpfFrequencies.end()));
+        host.setParameter("lpfFrequency", *std::min_element(lpfFrequencies.begin(), lpfFrequencies.end()));
+
+        const auto irLength = options.irLength > 0 ? options.irLength
+                                                   : roundToInt(std::ceil(host.getProcessor().getTailLengthSeconds() * options.sampleRate));
+        const auto numChannels = host.getProcessor().getMainBusNumOutputChannels();
+        const auto delayInterpolation = roundToInt(apvts.getRawParameterValue("delayInterpolation")->load());
+
+        const auto numAxisValues = delayTimes.size() + mixes.size() + hpfFrequencies.size() + lpfFrequencies.size();
+        const auto indexOffset = alignUp(sizeof(FileHeader) + numAxisValues * sizeof(float));
+        const auto dataOffset = alignUp(indexOffset + static_cast<uint64>(numCells) * sizeof(CellEntry));
+        const auto cellBytes = static_cast<uint64>(numChannels) * static_cast<uint64>(irLength) * sizeof(float);
+        const auto fileSize = dataOffset + static_cast<uint64>(numCells) * cellBytes;
+
+        std::cout << "Rendering " << String(numCells) << " impulse responses of " << irLength << " samples ("
+                  << delayTimes.size() << " delay times x " << mixes.size() << " mixes x " << hpfFrequencies.size()
+                  << " HPF x " << lpfFrequencies.size() << " LPF) into " << options.outputFile.getFullPathName()
+                  << ", " << File::descriptionOfSizeInBytes(static_cast<int64>(fileSize)) << std::endl;
+
+        // Size the file first; the jobs then write their cells straight into the mapping
+        options.outputFile.deleteFile();
+
+        {
+            FileOutputStream stream(options.outputFile);
+
+            if (stream.failedToOpen() || ! stream.writeRepeatedByte(0, static_cast<size_t>(fileSize)))
+            {
+                std::cout << "Could not write " << options.outputFile.getFullPathName() << std::endl;
+                return 1;
+            }
+        }
+
+        MemoryMappedFile mappedFile(options.outputFile, MemoryMappedFile::readWrite);
+
+        if (mappedFile.getData() == nullptr || mappedFile.getSize() != static_cast<size_t>(fileSize))
+        {
+            std::cout << "Could not map " << options.outputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        auto* fileData = static_cast<char*>(mappedFile.getData());
+
+        auto& header = *reinterpret_cast<FileHeader*>(fileData);
+        std::memcpy(header.magic, "XYIR", sizeof(header.magic));
+        header.version = formatVersion;
+        header.numChannels = static_cast<uint32>(numChannels);
+        header.irLength = static_cast<uint32>(irLength);
+        header.sampleRate = options.sampleRate;
+        header.numDelayTimes = static_cast<uint32>(delayTimes.size());
+        header.numMixes = static_cast<uint32>(mixes.size());
+        header.numHpfFrequencies = static_cast<uint32>(hpfFrequencies.size());
+        header.numLpfFrequencies = static_cast<uint32>(lpfFrequencies.size());
+        header.indexOffset = indexOffset;
+        header.dataOffset = dataOffset;
+        header.numCells = static_cast<uint32>(numCells);
+        header.delayInterpolation = static_cast<uint32>(delayInterpolation);
+
+        auto* axisValues = reinterpret_cast<float*>(fileData + sizeof(FileHeader));
+
+        for (const auto* axis : { &delayTimes, &mixes, &hpfFrequencies, &lpfFrequencies })
+            for (auto value : *axis)
+                *axisValues++ = value;
+
+        auto* entries = reinterpret_cast<CellEntry*>(fileData + indexOffset);
+        int cell = 0;
+
+        for (auto lpfFrequency : lpfFrequencies)
+            for (auto hpfFrequency : hpfFrequencies)
+                for (auto mix : mixes)
+                    for (auto delayTime : delayTimes)
+                    {
+                        entries[cell] = { delayTime, mix, hpfFrequency, lpfFrequency, dataOffset + static_cast<uint64>(cell) * cellBytes, 0.0f, 0.0f };
+                        ++cell;
+                    }
+
+        const auto numJobs = (cell + cellsPerJob - 1) / cellsPerJob;
+        const auto numThreads = jlimit(1, numJobs, options.numThreads);
+        const auto startTime = Time::getMillisecondCounterHiRes();
+
+        {
+            ThreadPool pool(numThreads);
+
+            for (int first = 0; first < cell; first += cellsPerJob)
+                pool.addJob(new RenderJob(fileData, first, jmin(first + cellsPerJob, cell)), true);
+
+            while (pool.getNumJobs() > 0)
+                Thread::sleep(50);
+        }
+
+        const auto seconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+        std::cout << "Done in " << String(seconds, 2) << " s on " << numThreads << " thread(s), "
+                  << String(cell / jmax(seconds, 1.0e-3), 0) << " cells/s" << std::endl;
+
+        return 0;
+    }
+}
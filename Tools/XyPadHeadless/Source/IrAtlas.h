@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    IrAtlas.h
+    Renders XyPadAudioProcessor's impulse response at every cell of a grid
+    of pad positions (delayTime x dryWetMix) and filter settings, on a
+    thread pool, into one indexed file that can be memory-mapped and read
+    in place.
+
+    File layout, all little-endian:
+
+        FileHeader                      at 0
+        axis values (float32)           delay times, then mixes, HPF and LPF
+                                        frequencies, right after the header
+        CellEntry[numCells]             at indexOffset
+        impulse responses (float32)     at dataOffset, one per cell in index
+                                        order; numChannels planar runs of
+                                        irLength samples each
+
+    The delay time varies fastest, then the mix, the HPF and the LPF, so
+    cell = ((lpf * numHpf + hpf) * numMixes + mix) * numDelayTimes + delay.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_BIG_ENDIAN
+ #error "IR atlases are written in native byte order, which has to be little-endian"
+#endif
+
+namespace IrAtlas
+{
+    struct FileHeader
+    {
+        char magic[4];             // "XYIR"
+        uint32 version;
+        uint32 numChannels;
+        uint32 irLength;           // samples per channel
+        double sampleRate;
+        uint32 numDelayTimes;
+        uint32 numMixes;
+        uint32 numHpfFrequencies;
+        uint32 numLpfFrequencies;
+        uint64 indexOffset;
+        uint64 dataOffset;
+        uint32 numCells;
+        uint32 delayInterpolation; // AudioParameterChoice index
+    };
+
+    struct CellEntry
+    {
+        float delayTime;
+        float dryWetMix;
+        float hpfFrequency;
+        float lpfFrequency;
+        uint64 dataOffset;         // from the start of the file
+        float peak;                // largest absolute sample over all channels
+        float energy;              // sum of squares over all channels
+    };
+
+    static_assert(sizeof(FileHeader) == 64, "FileHeader is part of the file format");
+    static_assert(sizeof(CellEntry) == 32, "CellEntry is part of the file format");
+
+    static constexpr uint32 formatVersion = 1;
+
+    struct Options
+    {
+        File outputFile;
+        double sampleRate = 48000.0;
+        int numDelayTimes = 15;                               // spread evenly over the parameter's range
+        int numMixes = 5;
+        Array<float> hpfFrequencies { 20.0f, 200.0f, 440.0f };
+        Array<float> lpfFrequencies { 20000.0f, 5000.0f, 2000.0f };
+        int irLength = 0;                                     // 0 uses the processor's tail length
+        int numThreads = SystemStats::getNumCpus();
+    };
+
+    // Returns 0 on success.
+    int run(const Options& options);
+}
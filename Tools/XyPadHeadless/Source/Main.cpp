@@ -0,0 +1,315 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Entry point of the XyPadHeadless console tool.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Batch.h"
+#include "Benchmark.h"
+#include "IrAtlas.h"
+#include "Regression.h"
+#include "RtSafetyCheck.h"
+#include "Trace.h"
+#include <iostream>
+
+static Array<double> parseDoubleList(const String& text)
+{
+    Array<double> values;
+
+    for (const auto& token : StringArray::fromTokens(text, ",", ""))
+        if (token.trim().isNotEmpty())
+            values.add(token.trim().getDoubleValue());
+
+    return values;
+}
+
+static Array<int> parseIntList(const String& text)
+{
+    Array<int> values;
+
+    for (const auto& token : StringArray::fromTokens(text, ",", ""))
+        if (token.trim().isNotEmpty())
+            values.add(token.trim().getIntValue());
+
+    return values;
+}
+
+static bool parseLayout(const String& name, AudioChannelSet& layout)
+{
+    if (name == "mono")        layout = AudioChannelSet::mono();
+    else if (name == "stereo") layout = AudioChannelSet::stereo();
+    else if (name == "5.1")    layout = AudioChannelSet::create5point1();
+    else if (name == "7.1")    layout = AudioChannelSet::create7point1();
+    else if (name == "7.1.4")  layout = AudioChannelSet::create7point1point4();
+    else                       return false;
+
+    return true;
+}
+
+static void runBenchmark(const ArgumentList& args)
+{
+    Benchmark::Options options;
+
+    if (args.containsOption("--rates"))
+        options.sampleRates = parseDoubleList(args.getValueForOption("--rates"));
+
+    if (args.containsOption("--blocks"))
+        options.blockSizes = parseIntList(args.getValueForOption("--blocks"));
+
+    if (args.containsOption("--seconds"))
+        options.secondsPerCase = args.getValueForOption("--seconds").getDoubleValue();
+
+    if (args.containsOption("--params"))
+    {
+        const auto wanted = StringArray::fromTokens(args.getValueForOption("--params"), ",", "");
+
+        for (const auto& set : Benchmark::getDefaultParameterSets())
+            if (wanted.contains(set.name))
+                options.parameterSets.push_back(set);
+    }
+
+    if (args.containsOption("--layout") && ! parseLayout(args.getValueForOption("--layout"), options.layout))
+        ConsoleApplication::fail("Unknown layout, expected mono, stereo, 5.1, 7.1 or 7.1.4");
+
+    options.csv = args.containsOption("--csv");
+
+    if (options.sampleRates.isEmpty() || options.blockSizes.isEmpty() || options.secondsPerCase <= 0.0)
+        ConsoleApplication::fail("Invalid benchmark options");
+
+   #if XYPAD_TRACE
+    // Created before the first processor so the audio path never sets it up
+    SharedResourcePointer<TraceSession> traceSession;
+   #else
+    if (args.containsOption("--trace"))
+        ConsoleApplication::fail("--trace needs a build with XYPAD_TRACE=1");
+   #endif
+
+    Benchmark::run(options);
+
+   #if XYPAD_TRACE
+    if (args.containsOption("--trace"))
+    {
+        // The buffers only hold the most recent spans, so this covers the last cases run
+        const auto file = File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--trace"));
+        const auto result = traceSession->writeChromeTrace(file);
+
+        if (result.failed())
+            ConsoleApplication::fail(result.getErrorMessage());
+
+        std::cout << "Trace written to " << file.getFullPathName() << std::endl;
+    }
+   #endif
+}
+
+static void runRtSafetyCheck(const ArgumentList& args)
+{
+    RtSafetyCheck::Options options;
+
+    if (args.containsOption("--rates"))
+        options.sampleRates = parseDoubleList(args.getValueForOption("--rates"));
+
+    if (args.containsOption("--blocks"))
+        options.maximumBlockSizes = parseIntList(args.getValueForOption("--blocks"));
+
+    if (args.containsOption("--blocks-per-case"))
+        options.blocksPerCase = args.getValueForOption("--blocks-per-case").getIntValue();
+
+    options.abortOnViolation = args.containsOption("--abort");
+
+    if (options.sampleRates.isEmpty() || options.maximumBlockSizes.isEmpty() || options.blocksPerCase <= 0)
+        ConsoleApplication::fail("Invalid rt-check options");
+
+    if (RtSafetyCheck::run(options) != 0)
+        ConsoleApplication::fail("Real-time safety check failed");
+}
+
+static void runRegression(const ArgumentList& args)
+{
+    Regression::Options options;
+    options.referenceDirectory = File::getCurrentWorkingDirectory().getChildFile(args.containsOption("--refs") ? args.getValueForOption("--refs")
+                                                                                                          : String("References"));
+    options.record = args.containsOption("--record");
+
+    if (args.containsOption("--tolerance"))
+        options.tolerance = args.getValueForOption("--tolerance").getDoubleValue();
+
+    if (options.tolerance < 0.0)
+        ConsoleApplication::fail("Invalid tolerance");
+
+    if (Regression::run(options) != 0)
+        ConsoleApplication::fail(options.record ? "Could not record the references" : "Regression checks failed");
+}
+
+static void runBatch(const ArgumentList& args)
+{
+    Batch::Options options;
+
+    args.failIfOptionIsMissing("--out");
+    options.outputDirectory = args.getFileForOption("--out");
+
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    // Every argument that is not an option is a file, or a folder whose audio files are all processed
+    for (int i = 1; i < args.size(); ++i)
+    {
+        if (args[i].isOption())
+            continue;
+
+        const auto file = args[i].resolveAsFile();
+
+        if (file.isDirectory())
+            options.inputFiles.addArray(file.findChildFiles(File::findFiles, false, formatManager.getWildcardForAllFormats()));
+        else if (file.existsAsFile())
+            options.inputFiles.add(file);
+        else
+            ConsoleApplication::fail("No such file: " + file.getFullPathName());
+    }
+
+    if (options.inputFiles.isEmpty())
+        ConsoleApplication::fail("No input files");
+
+    if (args.containsOption("--preset"))
+    {
+        const auto presetFile = args.getExistingFileForOption("--preset");
+        const auto xml = XmlDocument::parse(presetFile);
+
+        if (xml == nullptr)
+            ConsoleApplication::fail("Could not parse " + presetFile.getFullPathName());
+
+        options.preset = ValueTree::fromXml(*xml);
+    }
+
+    if (args.containsOption("--set"))
+    {
+        for (const auto& assignment : StringArray::fromTokens(args.getValueForOption("--set"), ",", ""))
+        {
+            if (! assignment.contains("="))
+                ConsoleApplication::fail("Expected parameterID=value, got " + assignment);
+
+            options.parameterValues.set(assignment.upToFirstOccurrenceOf("=", false, false).trim(),
+                                        assignment.fromFirstOccurrenceOf("=", false, false).trim());
+        }
+    }
+
+    if (args.containsOption("--threads"))
+        options.numThreads = args.getValueForOption("--threads").getIntValue();
+
+    if (args.containsOption("--chunk"))
+        options.chunkSize = args.getValueForOption("--chunk").getIntValue();
+
+    options.renderTail = args.containsOption("--tail");
+    options.overwrite = args.containsOption("--overwrite");
+
+    if (options.numThreads <= 0 || options.chunkSize <= 0)
+        ConsoleApplication::fail("Invalid batch options");
+
+    if (Batch::run(options) != 0)
+        ConsoleApplication::fail("Some files could not be processed");
+}
+
+static void runIrAtlas(const ArgumentList& args)
+{
+    IrAtlas::Options options;
+
+    args.failIfOptionIsMissing("--out");
+    options.outputFile = File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--out"));
+
+    if (args.containsOption("--rate"))
+        options.sampleRate = args.getValueForOption("--rate").getDoubleValue();
+
+    if (args.containsOption("--delay-steps"))
+        options.numDelayTimes = args.getValueForOption("--delay-steps").getIntValue();
+
+    if (args.containsOption("--mix-steps"))
+        options.numMixes = args.getValueForOption("--mix-steps").getIntValue();
+
+    const auto parseFrequencies = [&args](const String& option, Array<float>& frequencies)
+    {
+        if (! args.containsOption(option))
+            return;
+
+        frequencies.clear();
+
+        for (auto frequency : parseDoubleList(args.getValueForOption(option)))
+            frequencies.add(static_cast<float>(frequency));
+    };
+
+    parseFrequencies("--hpf", options.hpfFrequencies);
+    parseFrequencies("--lpf", options.lpfFrequencies);
+
+    if (args.containsOption("--length"))
+        options.irLength = args.getValueForOption("--length").getIntValue();
+
+    if (args.containsOption("--threads"))
+        options.numThreads = args.getValueForOption("--threads").getIntValue();
+
+    if (options.sampleRate <= 0.0 || options.numDelayTimes <= 0 || options.numMixes <= 0 || options.hpfFrequencies.isEmpty()
+        || options.lpfFrequencies.isEmpty() || options.irLength < 0 || options.numThreads <= 0)
+        ConsoleApplication::fail("Invalid IR atlas options");
+
+    if (IrAtlas::run(options) != 0)
+        ConsoleApplication::fail("Could not render the IR atlas");
+}
+
+int main(int argc, char* argv[])
+{
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    ConsoleApplication app;
+    app.addHelpCommand("--help|-h", "Usage: XyPadHeadless <command> [options]", true);
+
+    app.addCommand({ "--bench",
+                     "--bench [--rates=44100,48000] [--blocks=64,512] [--params=centre,automated] [--layout=7.1.4] [--seconds=5] [--csv] [--trace=trace.json]",
+                     "Measures processBlock throughput over a matrix of sample rates, block sizes and parameters.",
+                     "Reports ns per sample frame, the realtime factor and the worst-case block time for every case.\n"
+                     "Parameter sets: centre, left-haas, right-mid, automated, long-fb, bypassed.\n"
+                     "Layouts: mono, stereo (default), 5.1, 7.1, 7.1.4.\n"
+                     "--trace writes the processBlock stage spans as a Chrome trace (XYPAD_TRACE=1 builds only).",
+                     runBenchmark });
+
+    app.addCommand({ "--batch",
+                     "--batch <files or folders...> --out=folder [--preset=state.xml] [--set=delayTime=-10,dryWetMix=0.8] [--threads=N] [--chunk=4096] [--tail] [--overwrite]",
+                     "Processes audio files offline through the plugin, one processor instance per file, on a thread pool.",
+                     "Files stream through in chunks, so memory stays flat however long they are. Each output keeps the input's\n"
+                     "name, format, bit depth and metadata. --preset loads a parameter state saved as XML; --set then overrides\n"
+                     "individual parameters in the plugin's own ranges: delayTime is the pad position (-17.5 to 17.5), the\n"
+                     "filters are in Hz and dryWetMix and feedback run from 0 to 1. --tail appends the delay and filter tail,\n"
+                     "stopping early once it has been silent for 2 s. --threads defaults to the number of CPU cores.",
+                     runBatch });
+
+    app.addCommand({ "--ir-atlas",
+                     "--ir-atlas --out=atlas.xyir [--rate=48000] [--delay-steps=15] [--mix-steps=5] [--hpf=20,200,440] [--lpf=20000,5000,2000] [--length=samples] [--threads=N]",
+                     "Renders the impulse response at every cell of a delayTime x dryWetMix x HPF x LPF grid into one indexed file.",
+                     "The pad axes are spread evenly over the parameters' ranges; filter frequencies are snapped to theirs.\n"
+                     "Cells render in parallel in Haas mode, each from a freshly prepared processor, for the processor's\n"
+                     "tail length unless --length is given. The file is laid out to be memory-mapped; see IrAtlas.h.",
+                     runIrAtlas });
+
+    app.addCommand({ "--rt-check",
+                     "--rt-check [--rates=44100,192000] [--blocks=32,4096] [--blocks-per-case=400] [--abort]",
+                     "Fails if processBlock allocates, frees, locks or waits.",
+                     "Runs mono, stereo and 7.1.4 instances in single and double precision, re-preparing each one for every\n"
+                     "sample rate and maximum block size, with every parameter, the tempo and the bypass automated on the\n"
+                     "audio thread and block sizes varying from 1 sample to the maximum. The hooks are armed only around\n"
+                     "processBlock. Locks and waits are only intercepted on Linux.\n"
+                     "--abort stops at the first violation so a debugger or core dump shows where it happened.",
+                     runRtSafetyCheck });
+
+    app.addCommand({ "--regress",
+                     "--regress [--refs=References] [--record] [--tolerance=2e-3]",
+                     "Compares renders of fixed stimuli with golden references and runs the null tests.",
+                     "Impulses, a sine sweep and noise go through six pad/filter settings in mono and stereo at 48 and 96 kHz.\n"
+                     "Each render is compared with <refs>/<case>.wav and with renders split into other block sizes, and the\n"
+                     "double-precision render with <refs>/<case>_double.wav. Bypass must pass the input through bit for bit.\n"
+                     "The references are committed in Tools/XyPadHeadless/References, so run it from Tools/XyPadHeadless\n"
+                     "or pass --refs. A missing reference fails its check.\n"
+                     "--record rewrites the references; only do that when a change to the output is intended.",
+                     runRegression });
+
+    return app.findAndRunCommand(argc, argv);
+}
@@ -0,0 +1,337 @@
+#include "Regression.h"
+#include "HeadlessHost.h"
+
+#include <iostream>
+
+namespace Regression
+{
+    // Short enough to keep the committed references small; Long mode still
+    // gets three repeats in it.
+    static constexpr double lengthSeconds = 0.25;
+    static constexpr int referenceBlockSize = 512;
+
+    // Awkward sizes on purpose: single samples, sizes either side of the
+    // processor's 256-sample sub-blocks and one bigger than the reference.
+    static constexpr int nullTestBlockSizes[] = { 1, 37, 255, 256, 257, 4096 };
+
+    struct Setting
+    {
+        const char* name;
+        float delayTime;
+        float dryWetMix;
+        float hpfFrequency;
+        float lpfFrequency;
+        int delayInterpolation;
+        int delayMode;
+        float feedback;
+    };
+
+    static const Setting settings[] = {
+        { "centre",              0.0f,   0.5f, 20.0f,   20000.0f, 0, 0, 0.0f },
+        { "haas-left-linear",    -17.5f, 1.0f, 440.0f,  5000.0f,  0, 0, 0.0f },
+        { "haas-right-lagrange", 8.75f,  0.7f, 200.0f,  12000.0f, 1, 0, 0.0f },
+        { "haas-left-thiran",    -6.3f,  1.0f, 100.0f,  16000.0f, 2, 0, 0.0f },
+        { "narrow-band",         3.0f,   1.0f, 1000.0f, 2000.0f,  0, 0, 0.0f },
+        { "long-feedback",       0.7f,   0.5f, 200.0f,  8000.0f,  0, 1, 0.6f }  // 80 ms repeats
+    };
+
+    static const char* const stimuli[] = { "impulse", "sweep", "noise" };
+
+    static const std::pair<const char*, AudioChannelSet> layouts[] = {
+        { "mono", AudioChannelSet::mono() },
+        { "stereo", AudioChannelSet::stereo() }
+    };
+
+    static const double sampleRates[] = { 48000.0, 96000.0 };
+
+    //==============================================================================
+    // Each channel gets different material so swapped or shared channel state shows up.
+    static AudioBuffer<float> createStimulus(const String& name, int numChannels, double sampleRate)
+    {
+        const auto numSamples = static_cast<int>(lengthSeconds * sampleRate);
+        AudioBuffer<float> buffer(numChannels, numSamples);
+        buffer.clear();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = buffer.getWritePointer(channel);
+
+            if (name == "impulse")
+            {
+                // The second impulse lands on a line that already holds signal
+                data[64 + 31 * channel] = 1.0f;
+                data[numSamples / 2 + 17 * channel] = -0.5f;
+            }
+            else if (name == "sweep")
+            {
+                // Exponential sine sweep from 20 Hz to just under Nyquist
+                const auto startFrequency = 20.0;
+                const auto endFrequency = jmin(20000.0, sampleRate * 0.45);
+                const auto rate = std::log(endFrequency / startFrequency) / numSamples;
+                const auto offset = channel * MathConstants<double>::halfPi;
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const auto phase = MathConstants<double>::twoPi * startFrequency * (std::exp(rate * i) - 1.0) / (rate * sampleRate);
+                    data[i] = static_cast<float>(0.5 * std::sin(phase + offset));
+                }
+            }
+            else
+            {
+                // A fixed LCG rather than Random, so the committed references
+                // can't drift with the JUCE version
+                auto state = static_cast<uint32>(0x5eed + channel);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    state = state * 1664525u + 1013904223u;
+                    data[i] = (static_cast<float>(state >> 8) / 16777216.0f * 2.0f - 1.0f) * 0.25f;
+                }
+            }
+        }
+
+        return buffer;
+    }
+
+    static void applySetting(HeadlessHost& host, const Setting& setting, bool bypass)
+    {
+        host.setParameter("delayTime", setting.delayTime);
+        host.setParameter("dryWetMix", setting.dryWetMix);
+        host.setParameter("hpfFrequency", setting.hpfFrequency);
+        host.setParameter("lpfFrequency", setting.lpfFrequency);
+        host.setParameter("delayInterpolation", static_cast<float>(setting.delayInterpolation));
+        host.setParameter("delayMode", static_cast<float>(setting.delayMode));
+        host.setParameter("feedback", setting.feedback);
+        host.setParameter("tempoSync", 0.0f);
+        host.setParameter("bypass", bypass ? 1.0f : 0.0f);
+    }
+
+    // Parameters are set before prepareToPlay, so the smoothers start settled
+    // and nothing depends on how the first blocks happen to be split.
+    template <typename SampleType>
+    static AudioBuffer<float> render(const AudioChannelSet& layout, double sampleRate, const Setting& setting,
+                                     bool bypass, const AudioBuffer<float>& input, int blockSize)
+    {
+        HeadlessHost host;
+        const auto layoutAccepted = host.setChannelLayout(layout);
+        jassert(layoutAccepted);
+        ignoreUnused(layoutAccepted);
+
+        applySetting(host, setting, bypass);
+        host.prepare(sampleRate, blockSize, std::is_same<SampleType, double>::value ? AudioProcessor::doublePrecision
+                                                                                    : AudioProcessor::singlePrecision);
+
+        const auto numChannels = input.getNumChannels();
+        const auto numSamples = input.getNumSamples();
+
+        AudioBuffer<SampleType> buffer(numChannels, numSamples);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample(channel, i, static_cast<SampleType>(input.getSample(channel, i)));
+
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), numChannels, start, jmin(blockSize, numSamples - start));
+            host.process(block);
+        }
+
+        AudioBuffer<float> output(numChannels, numSamples);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                output.setSample(channel, i, static_cast<float>(buffer.getSample(channel, i)));
+
+        return output;
+    }
+
+    //==============================================================================
+    struct Difference
+    {
+        bool shapeMatches = true;
+        double maximum = 0.0;
+        int channel = 0;
+        int sample = 0;
+
+        String describe() const
+        {
+            if (! shapeMatches)
+                return "channel count or length differs";
+
+            return "max " + String(maximum, 9) + " at ch " + String(channel) + " sample " + String(sample);
+        }
+    };
+
+    static Difference compare(const AudioBuffer<float>& actual, const AudioBuffer<float>& expected)
+    {
+        Difference difference;
+
+        if (actual.getNumChannels() != expected.getNumChannels() || actual.getNumSamples() != expected.getNumSamples())
+        {
+            difference.shapeMatches = false;
+            return difference;
+        }
+
+        for (int channel = 0; channel < actual.getNumChannels(); ++channel)
+        {
+            for (int i = 0; i < actual.getNumSamples(); ++i)
+            {
+                const auto delta = std::abs(static_cast<double>(actual.getSample(channel, i)) - expected.getSample(channel, i));
+
+                // Written so that a NaN always counts as the worst difference
+                if (! (delta <= difference.maximum))
+                {
+                    difference.maximum = std::isnan(delta) ? std::numeric_limits<double>::infinity() : delta;
+                    difference.channel = channel;
+                    difference.sample = i;
+                }
+            }
+        }
+
+        return difference;
+    }
+
+    // 32-bit WAV stores the float render bit for bit.
+    static Result writeReference(const File& file, const AudioBuffer<float>& buffer, double sampleRate)
+    {
+        file.deleteFile();
+        auto stream = std::make_unique<FileOutputStream>(file);
+
+        if (! stream->openedOk())
+            return Result::fail("Could not open " + file.getFullPathName());
+
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, static_cast<unsigned int>(buffer.getNumChannels()), 32, {}, 0));
+
+        if (writer == nullptr)
+            return Result::fail("Could not create a WAV writer for " + file.getFullPathName());
+
+        stream.release(); // the writer owns it now
+
+        if (! writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples()))
+            return Result::fail("Could not write " + file.getFullPathName());
+
+        return Result::ok();
+    }
+
+    static bool readReference(const File& file, AudioBuffer<float>& buffer)
+    {
+        if (! file.existsAsFile())
+            return false;
+
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatReader> reader(wav.createReaderFor(file.createInputStream().release(), true));
+
+        if (reader == nullptr)
+            return false;
+
+        const auto numSamples = static_cast<int>(reader->lengthInSamples);
+        buffer.setSize(static_cast<int>(reader->numChannels), numSamples);
+        return reader->read(&buffer, 0, numSamples, 0, true, true);
+    }
+
+    //==============================================================================
+    int run(const Options& options)
+    {
+        if (options.record && ! options.referenceDirectory.createDirectory())
+        {
+            std::cout << "Could not create " << options.referenceDirectory.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        int numFailed = 0;
+
+        const auto report = [&numFailed](const String& caseName, const String& check, bool passed, const String& detail)
+        {
+            if (! passed)
+                ++numFailed;
+
+            std::cout << caseName.paddedRight(' ', 46) << check.paddedRight(' ', 12) << (passed ? "ok    " : "FAIL  ") << detail << std::endl;
+        };
+
+        const auto checkReference = [&](const String& caseName, const String& check, const File& file, const AudioBuffer<float>& output, double tolerance)
+        {
+            AudioBuffer<float> reference;
+
+            if (! readReference(file, reference))
+            {
+                report(caseName, check, false, "missing " + file.getFullPathName());
+                return;
+            }
+
+            const auto difference = compare(output, reference);
+            report(caseName, check, difference.shapeMatches && difference.maximum <= tolerance, difference.describe());
+        };
+
+        for (auto sampleRate : sampleRates)
+        {
+            for (const auto& layout : layouts)
+            {
+                for (const auto* stimulusName : stimuli)
+                {
+                    const auto input = createStimulus(stimulusName, layout.second.size(), sampleRate);
+                    const auto baseName = String(stimulusName) + "_" + layout.first + "_" + String(static_cast<int>(sampleRate));
+
+                    for (const auto& setting : settings)
+                    {
+                        const auto caseName = baseName + "_" + setting.name;
+                        const auto output = render<float>(layout.second, sampleRate, setting, false, input, referenceBlockSize);
+                        const auto doubleOutput = render<double>(layout.second, sampleRate, setting, false, input, referenceBlockSize);
+
+                        if (options.record)
+                        {
+                            for (const auto* rendered : { &output, &doubleOutput })
+                            {
+                                const auto file = options.referenceDirectory.getChildFile(caseName + (rendered == &output ? ".wav" : "_double.wav"));
+                                const auto result = writeReference(file, *rendered, sampleRate);
+                                report(caseName, "record", result.wasOk(), result.getErrorMessage());
+                            }
+
+                            continue;
+                        }
+
+                        checkReference(caseName, "reference", options.referenceDirectory.getChildFile(caseName + ".wav"), output, options.tolerance);
+
+                        // Null tests: the same input split differently must give the same output
+                        auto worstBlocks = Difference();
+                        auto worstBlockSize = nullTestBlockSizes[0];
+
+                        for (auto blockSize : nullTestBlockSizes)
+                        {
+                            const auto difference = compare(render<float>(layout.second, sampleRate, setting, false, input, blockSize), output);
+
+                            if (! difference.shapeMatches || ! (difference.maximum <= worstBlocks.maximum))
+                            {
+                                worstBlocks = difference;
+                                worstBlockSize = blockSize;
+                            }
+                        }
+
+                        report(caseName, "block size", worstBlocks.shapeMatches && worstBlocks.maximum <= options.blockSizeTolerance,
+                               worstBlocks.describe() + " (" + String(worstBlockSize) + "-sample blocks)");
+
+                        // The double path has its own reference: against the float render
+                        // it would only measure the float path's coefficient rounding
+                        checkReference(caseName, "precision", options.referenceDirectory.getChildFile(caseName + "_double.wav"), doubleOutput, options.tolerance);
+                    }
+
+                    if (! options.record)
+                    {
+                        // Bypass has to be bit-exact, whatever the settings behind it
+                        const auto bypassed = compare(render<float>(layout.second, sampleRate, settings[1], true, input, referenceBlockSize), input);
+                        report(baseName + "_bypass", "null", bypassed.shapeMatches && bypassed.maximum == 0.0, bypassed.describe());
+                    }
+                }
+            }
+        }
+
+        std::cout << std::endl;
+
+        if (options.record)
+            std::cout << "References written to " << options.referenceDirectory.getFullPathName() << std::endl;
+        else
+            std::cout << (numFailed == 0 ? String("All regression checks passed.") : String(numFailed) + " check(s) failed.") << std::endl;
+
+        return numFailed;
+    }
+}
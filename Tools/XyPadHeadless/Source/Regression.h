@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    Regression.h
+    Golden-output regression suite for XyPadAudioProcessor. Renders fixed
+    stimuli through a grid of pad positions, filter settings, layouts and
+    sample rates and compares the output with the references committed in
+    Tools/XyPadHeadless/References, in single and double precision. Null tests check
+    that the output does not depend on the host's block size, and that
+    bypass passes the input through untouched.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Regression
+{
+    struct Options
+    {
+        File referenceDirectory;
+        bool record = false;  // write references instead of comparing
+
+        // Largest absolute difference from a reference that still passes, for
+        // the float and the double render alike. The committed references
+        // come from one build, and compilers that contract a * b + c into an
+        // FMA round differently: the 20 Hz float high-pass and the float
+        // delay times under a 20 kHz sweep then move by up to 1e-3 (GCC
+        // -march=native against -O1 without FMA).
+        double tolerance = 2.0e-3;
+
+        // Within one build, going idle is the only thing that happens on a
+        // block boundary, and only once the output has stayed under -120 dB
+        // for a whole tail, so a render cut at another sample differs by
+        // 2e-8 at most. GCC at -O3 with FMA breaks this by up to 2e-4: it
+        // fuses the filter recurrence differently in its unrolled copies.
+        double blockSizeTolerance = 1.0e-6;
+    };
+
+    // Returns the number of failed checks; a missing reference is a failure.
+    int run(const Options& options);
+}
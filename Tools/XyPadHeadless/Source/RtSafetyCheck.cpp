@@ -0,0 +1,519 @@
+#include "RtSafetyCheck.h"
+#include "HeadlessHost.h"
+
+#include <iostream>
+#include <mutex>
+
+#if JUCE_LINUX
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <unistd.h>
+ #include <cerrno>
+ #include <ctime>
+#endif
+
+namespace RtSafetyCheck
+{
+    enum class Violation { allocation, deallocation, lock, wait };
+    static constexpr int numViolationKinds = 4;
+
+    // What the armed thread is doing. Only processBlock is the plugin's own
+    // code; parameter delivery runs JUCE's listener code, which takes a lock
+    // the plugin can do nothing about, so it is counted apart.
+    enum class Scope { none, processBlock, parameterDelivery };
+
+    // Only the thread that runs processBlock ever arms itself, so the
+    // harness and any JUCE threads can allocate and lock freely.
+    static thread_local Scope armedScope = Scope::none;
+    static std::array<std::array<std::atomic<int>, numViolationKinds>, 2> violationCounts {};
+    static std::atomic<bool> abortOnViolation { false };
+
+    // Called from inside the allocator and lock hooks: must not allocate or lock.
+    static void noteViolation(Violation violation) noexcept
+    {
+        const auto scope = armedScope;
+
+        if (scope == Scope::none)
+            return;
+
+        violationCounts[scope == Scope::processBlock ? 0 : 1][static_cast<size_t>(violation)].fetch_add(1, std::memory_order_relaxed);
+
+        // Leaves the offending call on the stack for the debugger or core dump
+        if (scope == Scope::processBlock && abortOnViolation.load(std::memory_order_relaxed))
+            std::abort();
+    }
+
+    struct ScopedArm
+    {
+        explicit ScopedArm(Scope scope) noexcept { armedScope = scope; }
+        ~ScopedArm() noexcept                    { armedScope = Scope::none; }
+    };
+
+    using Counts = std::array<int, numViolationKinds>;
+
+    static Counts takeCounts(Scope scope) noexcept
+    {
+        auto& counters = violationCounts[scope == Scope::processBlock ? 0 : 1];
+        Counts counts;
+
+        for (size_t i = 0; i < counts.size(); ++i)
+            counts[i] = counters[i].exchange(0, std::memory_order_relaxed);
+
+        return counts;
+    }
+}
+
+//==============================================================================
+// Hooks. Each one notes the call and forwards to the real implementation
+// without going back through another hook.
+
+#if JUCE_LINUX
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+}
+
+static void* allocateUnchecked(size_t size) noexcept { return __libc_malloc(size); }
+static void freeUnchecked(void* pointer) noexcept    { __libc_free(pointer); }
+#else
+static void* allocateUnchecked(size_t size) noexcept { return std::malloc(size); }
+static void freeUnchecked(void* pointer) noexcept    { std::free(pointer); }
+#endif
+
+static void* allocateChecked(size_t size)
+{
+    RtSafetyCheck::noteViolation(RtSafetyCheck::Violation::allocation);
+
+    if (auto* pointer = allocateUnchecked(size == 0 ? 1 : size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+static void freeChecked(void* pointer) noexcept
+{
+    if (pointer == nullptr)
+        return;
+
+    RtSafetyCheck::noteViolation(RtSafetyCheck::Violation::deallocation);
+    freeUnchecked(pointer);
+}
+
+void* operator new(size_t size)                                   { return allocateChecked(size); }
+void* operator new[](size_t size)                                 { return allocateChecked(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept   { try { return allocateChecked(size); } catch (...) { return nullptr; } }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { try { return allocateChecked(size); } catch (...) { return nullptr; } }
+
+void operator delete(void* pointer) noexcept                          { freeChecked(pointer); }
+void operator delete[](void* pointer) noexcept                        { freeChecked(pointer); }
+void operator delete(void* pointer, size_t) noexcept                  { freeChecked(pointer); }
+void operator delete[](void* pointer, size_t) noexcept                { freeChecked(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept   { freeChecked(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { freeChecked(pointer); }
+
+#if JUCE_LINUX
+// Symbols defined in the executable take precedence over libc's, so these
+// also catch calls made from inside JUCE and the standard library.
+template <typename Function>
+static Function findNext(std::atomic<Function>& cached, const char* name) noexcept
+{
+    auto function = cached.load(std::memory_order_relaxed);
+
+    if (function == nullptr)
+    {
+        function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+        cached.store(function, std::memory_order_relaxed);
+    }
+
+    return function;
+}
+
+using RtSafetyCheck::Violation;
+using RtSafetyCheck::noteViolation;
+
+extern "C"
+{
+    void* malloc(size_t size) noexcept
+    {
+        noteViolation(Violation::allocation);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) noexcept
+    {
+        noteViolation(Violation::allocation);
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size) noexcept
+    {
+        noteViolation(Violation::allocation);
+        return __libc_realloc(pointer, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) noexcept
+    {
+        noteViolation(Violation::allocation);
+        return __libc_memalign(alignment, size);
+    }
+
+    void* memalign(size_t alignment, size_t size) noexcept
+    {
+        noteViolation(Violation::allocation);
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size) noexcept
+    {
+        noteViolation(Violation::allocation);
+        *result = __libc_memalign(alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    void free(void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            noteViolation(Violation::deallocation);
+
+        __libc_free(pointer);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+    {
+        noteViolation(Violation::lock);
+        static std::atomic<int (*)(pthread_mutex_t*)> next { nullptr };
+        return findNext(next, "pthread_mutex_lock")(mutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* lock) noexcept
+    {
+        noteViolation(Violation::lock);
+        static std::atomic<int (*)(pthread_rwlock_t*)> next { nullptr };
+        return findNext(next, "pthread_rwlock_rdlock")(lock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* lock) noexcept
+    {
+        noteViolation(Violation::lock);
+        static std::atomic<int (*)(pthread_rwlock_t*)> next { nullptr };
+        return findNext(next, "pthread_rwlock_wrlock")(lock);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        noteViolation(Violation::wait);
+        static std::atomic<int (*)(pthread_cond_t*, pthread_mutex_t*)> next { nullptr };
+        return findNext(next, "pthread_cond_wait")(condition, mutex);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const timespec* timeout)
+    {
+        noteViolation(Violation::wait);
+        static std::atomic<int (*)(pthread_cond_t*, pthread_mutex_t*, const timespec*)> next { nullptr };
+        return findNext(next, "pthread_cond_timedwait")(condition, mutex, timeout);
+    }
+
+    int sem_wait(sem_t* semaphore)
+    {
+        noteViolation(Violation::wait);
+        static std::atomic<int (*)(sem_t*)> next { nullptr };
+        return findNext(next, "sem_wait")(semaphore);
+    }
+
+    int nanosleep(const timespec* duration, timespec* remaining)
+    {
+        noteViolation(Violation::wait);
+        static std::atomic<int (*)(const timespec*, timespec*)> next { nullptr };
+        return findNext(next, "nanosleep")(duration, remaining);
+    }
+
+    int usleep(useconds_t microseconds)
+    {
+        noteViolation(Violation::wait);
+        static std::atomic<int (*)(useconds_t)> next { nullptr };
+        return findNext(next, "usleep")(microseconds);
+    }
+}
+
+#endif
+
+//==============================================================================
+namespace RtSafetyCheck
+{
+    static const char* const violationNames[] = { "allocations", "deallocations", "locks", "blocking waits" };
+
+    // A tempo that changes every block keeps the tempo-sync path busy.
+    class RampingPlayHead : public AudioPlayHead
+    {
+    public:
+        Optional<PositionInfo> getPosition() const override
+        {
+            PositionInfo position;
+            position.setBpm(bpm);
+            position.setIsPlaying(true);
+            return position;
+        }
+
+        double bpm = 120.0;
+    };
+
+    // Looked up before arming: building the parameter IDs would allocate.
+    struct AutomatedParameters
+    {
+        explicit AutomatedParameters(XyPadAudioProcessor& processor)
+        {
+            auto& apvts = processor.getApvts();
+            delayTime = apvts.getParameter("delayTime");
+            dryWetMix = apvts.getParameter("dryWetMix");
+            hpfFrequency = apvts.getParameter("hpfFrequency");
+            lpfFrequency = apvts.getParameter("lpfFrequency");
+            delayInterpolation = apvts.getParameter("delayInterpolation");
+            delayMode = apvts.getParameter("delayMode");
+            feedback = apvts.getParameter("feedback");
+            tempoSync = apvts.getParameter("tempoSync");
+            bypass = apvts.getParameter("bypass");
+        }
+
+        RangedAudioParameter* delayTime;
+        RangedAudioParameter* dryWetMix;
+        RangedAudioParameter* hpfFrequency;
+        RangedAudioParameter* lpfFrequency;
+        RangedAudioParameter* delayInterpolation;
+        RangedAudioParameter* delayMode;
+        RangedAudioParameter* feedback;
+        RangedAudioParameter* tempoSync;
+        RangedAudioParameter* bypass;
+    };
+
+    // What plugin wrappers do with host automation inside the audio callback.
+    static void deliver(RangedAudioParameter* parameter, float value)
+    {
+        const auto normalised = parameter->convertTo0to1(value);
+        parameter->setValue(normalised);
+        parameter->sendValueChangedMessageToListeners(normalised);
+    }
+
+    static void automate(AutomatedParameters& parameters, RampingPlayHead& playHead, int block)
+    {
+        const auto phase = MathConstants<float>::twoPi * static_cast<float>(block % 96) / 96.0f;
+        const auto lfo = std::sin(phase);
+
+        deliver(parameters.delayTime, 17.5f * lfo);
+        deliver(parameters.dryWetMix, 0.5f + 0.5f * std::cos(phase));
+        deliver(parameters.hpfFrequency, 200.0f + 150.0f * lfo);
+        deliver(parameters.lpfFrequency, 6000.0f - 4000.0f * lfo);
+        deliver(parameters.feedback, 0.475f + 0.475f * lfo);
+        deliver(parameters.delayInterpolation, static_cast<float>((block / 37) % 3));
+        deliver(parameters.delayMode, static_cast<float>((block / 53) % 2));
+        deliver(parameters.tempoSync, static_cast<float>((block / 71) % 2));
+        deliver(parameters.bypass, (block / 43) % 5 == 4 ? 1.0f : 0.0f);
+
+        playHead.bpm = 60.0 + block % 120;
+    }
+
+    // Cycles through awkward sizes so sub-block remainders and tiny blocks get
+    // exercised as well as the full size.
+    static int getBlockSize(int block, int maximumBlockSize)
+    {
+        static constexpr int sizes[] = { 0, 1, 7, 13, 255, 256, 257, -1 };
+        const auto size = sizes[block % numElementsInArray(sizes)];
+
+        if (size == 0)  return maximumBlockSize;
+        if (size == -1) return jmax(1, maximumBlockSize - 1);
+        return jmin(size, maximumBlockSize);
+    }
+
+    template <typename SampleType>
+    static void fillNoise(AudioBuffer<SampleType>& buffer, int numSamples, Random& random)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            auto* data = buffer.getWritePointer(channel);
+
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = static_cast<SampleType>((random.nextFloat() * 2.0f - 1.0f) * 0.25f);
+        }
+    }
+
+    struct CaseCounts
+    {
+        Counts processBlock;
+        Counts parameterDelivery;
+    };
+
+    template <typename SampleType>
+    static CaseCounts runCase(HeadlessHost& host, AutomatedParameters& parameters, RampingPlayHead& playHead,
+                          double sampleRate, int maximumBlockSize, int numBlocks)
+    {
+        constexpr auto precision = std::is_same<SampleType, double>::value ? AudioProcessor::doublePrecision
+                                                                           : AudioProcessor::singlePrecision;
+        host.prepare(sampleRate, maximumBlockSize, precision);
+
+        const auto numChannels = host.getProcessor().getTotalNumInputChannels();
+        AudioBuffer<SampleType> buffer(numChannels, maximumBlockSize);
+        Random random(0x5eed);
+
+        takeCounts(Scope::processBlock);
+        takeCounts(Scope::parameterDelivery);
+
+        const auto processArmed = [&](int numSamples, int block, bool automated, bool hostBypassed)
+        {
+            AudioBuffer<SampleType> view(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+            if (automated)
+            {
+                const ScopedArm arm(Scope::parameterDelivery);
+                automate(parameters, playHead, block);
+            }
+
+            const ScopedArm arm(Scope::processBlock);
+
+            if (hostBypassed)
+                host.processBypassed(view);
+            else
+                host.process(view);
+        };
+
+        // Every parameter moves on every block, including mode, interpolation,
+        // tempo sync and both kinds of bypass.
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const auto numSamples = getBlockSize(block, maximumBlockSize);
+            fillNoise(buffer, numSamples, random);
+            processArmed(numSamples, block, true, (block / 89) % 4 == 3);
+        }
+
+        // A second of silence in Haas mode drains the tail and goes idle; the
+        // noise after it wakes the processor up again.
+        deliver(parameters.delayMode, 0.0f);
+        deliver(parameters.bypass, 0.0f);
+
+        const auto silentBlocks = static_cast<int>(std::ceil(sampleRate / maximumBlockSize));
+        buffer.clear();
+
+        for (int block = 0; block < silentBlocks; ++block)
+            processArmed(maximumBlockSize, block, false, false);
+
+        for (int block = 0; block < 16; ++block)
+        {
+            fillNoise(buffer, maximumBlockSize, random);
+            processArmed(maximumBlockSize, block, false, false);
+        }
+
+        return { takeCounts(Scope::processBlock), takeCounts(Scope::parameterDelivery) };
+    }
+
+    static bool runSelfTest()
+    {
+        takeCounts(Scope::processBlock);
+
+        {
+            const ScopedArm arm(Scope::processBlock);
+            ::operator delete(::operator new(16));
+
+           #if JUCE_LINUX
+            std::mutex mutex;
+            mutex.lock();
+            mutex.unlock();
+           #endif
+        }
+
+        const auto counts = takeCounts(Scope::processBlock);
+        auto ok = counts[static_cast<size_t>(Violation::allocation)] > 0
+               && counts[static_cast<size_t>(Violation::deallocation)] > 0;
+
+       #if JUCE_LINUX
+        ok = ok && counts[static_cast<size_t>(Violation::lock)] > 0;
+       #endif
+
+        return ok;
+    }
+
+    static String listViolations(const Counts& counts)
+    {
+        StringArray found;
+
+        for (size_t i = 0; i < counts.size(); ++i)
+            if (counts[i] > 0)
+                found.add(String(counts[i]) + " " + violationNames[i]);
+
+        return found.joinIntoString(", ");
+    }
+
+    int run(const Options& options)
+    {
+        if (! runSelfTest())
+        {
+            std::cout << "Self-test failed: the interception hooks are not active in this build." << std::endl;
+            return 1;
+        }
+
+       #if ! JUCE_LINUX
+        std::cout << "Only operator new/delete are intercepted on this platform; locks and waits are not checked." << std::endl;
+       #endif
+
+        abortOnViolation = options.abortOnViolation;
+
+        const std::pair<const char*, AudioChannelSet> layouts[] = {
+            { "mono", AudioChannelSet::mono() },
+            { "stereo", AudioChannelSet::stereo() },
+            { "7.1.4", AudioChannelSet::create7point1point4() }
+        };
+
+        std::cout << "  layout  precision    rate  block  result" << std::endl;
+
+        int numFailed = 0;
+
+        for (const auto& layout : layouts)
+        {
+            for (auto useDouble : { false, true })
+            {
+                HeadlessHost host;
+                const auto layoutAccepted = host.setChannelLayout(layout.second);
+                jassert(layoutAccepted);
+                ignoreUnused(layoutAccepted);
+
+                RampingPlayHead playHead;
+                host.setPlayHead(&playHead);
+                AutomatedParameters parameters(host.getProcessor());
+
+                // One instance sees every rate and block size in turn, the way
+                // a host re-prepares a plugin when its settings change.
+                for (auto sampleRate : options.sampleRates)
+                {
+                    for (auto maximumBlockSize : options.maximumBlockSizes)
+                    {
+                        const auto counts = useDouble
+                            ? runCase<double>(host, parameters, playHead, sampleRate, maximumBlockSize, options.blocksPerCase)
+                            : runCase<float>(host, parameters, playHead, sampleRate, maximumBlockSize, options.blocksPerCase);
+
+                        const auto violations = listViolations(counts.processBlock);
+                        const auto deliveryViolations = listViolations(counts.parameterDelivery);
+
+                        if (violations.isNotEmpty())
+                            ++numFailed;
+
+                        std::cout << String(layout.first).paddedLeft(' ', 8)
+                                  << String(useDouble ? "double" : "single").paddedLeft(' ', 11)
+                                  << String(sampleRate, 0).paddedLeft(' ', 8)
+                                  << String(maximumBlockSize).paddedLeft(' ', 7)
+                                  << "  " << (violations.isEmpty() ? String("ok") : "FAIL: " + violations)
+                                  << (deliveryViolations.isEmpty() ? String() : "  (parameter delivery: " + deliveryViolations + ")")
+                                  << std::endl;
+                    }
+                }
+
+                host.setPlayHead(nullptr);
+            }
+        }
+
+        std::cout << std::endl << (numFailed == 0 ? String("No real-time safety violations.")
+                                                  : String(numFailed) + " case(s) failed.") << std::endl;
+        return numFailed;
+    }
+}
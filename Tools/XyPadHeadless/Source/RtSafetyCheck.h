@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+    RtSafetyCheck.h
+    Runs XyPadAudioProcessor under the headless host with allocation and
+    lock interception armed only while processBlock runs, and fails on any
+    allocation, deallocation, lock or blocking wait on the audio thread.
+
+    Allocations are caught on every platform through the global operator
+    new/delete. On Linux the C allocator, pthread locks, condition
+    variables, semaphores and sleeps are interposed as well.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace RtSafetyCheck
+{
+    struct Options
+    {
+        Array<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0 };
+        Array<int> maximumBlockSizes { 32, 512, 4096 };
+        int blocksPerCase = 400;
+        bool abortOnViolation = false;
+    };
+
+    // Returns the number of cases with at least one violation; a failed
+    // self-test counts as one.
+    int run(const Options& options);
+}